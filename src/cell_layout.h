@@ -0,0 +1,43 @@
+#ifndef CELLLAYOUT_INCLUDE
+#define CELLLAYOUT_INCLUDE
+
+// How the cells of a grid (the sub_domain, or the grids of the route planner) are laid out in memory, which can be
+// overridden when compiling, e.g. make CPPFLAGS="-DCELL_LAYOUT_TO_USE=1" for the blocked layout
+// 0 = row major, the cells of each X follow one another in Y, so a step in X jumps over a whole column of cells
+// 1 = blocked, the grid is split into square blocks of CELL_BLOCK_SIZE by CELL_BLOCK_SIZE cells held one after another,
+// with the cells of each block row major, so the neighbours of a cell are normally in the same block
+// 2 = Z-order, blocked as above but the cells of each block follow a Z-order (Morton) curve, which interleaves the bits
+// of X and Y so that neighbours in either dimension are equally close
+#ifndef CELL_LAYOUT_TO_USE
+#define CELL_LAYOUT_TO_USE 0
+#endif
+
+// Width of the blocks in cells, as a power of two, blocks of 8 by 8 cells of the sub_domain fill a few pages
+#define CELL_BLOCK_BITS 3
+#define CELL_BLOCK_SIZE (1 << CELL_BLOCK_BITS)
+#define CELL_BLOCK_MASK (CELL_BLOCK_SIZE - 1)
+// Number of blocks covering size cells in one dimension
+#define CELL_BLOCKS(size) (((size) + CELL_BLOCK_MASK) >> CELL_BLOCK_BITS)
+
+// CELL_INDEX gives the index of cell x, y of a grid that is size_y cells in Y, and CELL_GRID_SIZE the number of cells to
+// allocate for a grid of size_x by size_y cells, which for the blocked layouts is rounded up to whole blocks. The
+// arguments are evaluated more than once
+#if CELL_LAYOUT_TO_USE == 0
+#define CELL_INDEX(x, y, size_y) ((long long)(x) * (size_y) + (y))
+#define CELL_GRID_SIZE(size_x, size_y) ((long long)(size_x) * (size_y))
+#else
+#if CELL_LAYOUT_TO_USE == 1
+#define CELL_OFFSET_IN_BLOCK(x, y) ((((x) & CELL_BLOCK_MASK) << CELL_BLOCK_BITS) | ((y) & CELL_BLOCK_MASK))
+#elif CELL_LAYOUT_TO_USE == 2
+// Spreads the three bits of a coordinate within its block out to every other bit, looked up from a table of the eight
+#define CELL_SPREAD_BITS(v) ("\x00\x01\x04\x05\x10\x11\x14\x15"[(v)])
+#define CELL_OFFSET_IN_BLOCK(x, y) ((CELL_SPREAD_BITS((x) & CELL_BLOCK_MASK) << 1) | CELL_SPREAD_BITS((y) & CELL_BLOCK_MASK))
+#else
+#error "CELL_LAYOUT_TO_USE must be 0 (row major), 1 (blocked) or 2 (Z-order)"
+#endif
+#define CELL_INDEX(x, y, size_y) \
+  (((((long long)((x) >> CELL_BLOCK_BITS) * CELL_BLOCKS(size_y)) + ((y) >> CELL_BLOCK_BITS)) << (2 * CELL_BLOCK_BITS)) | CELL_OFFSET_IN_BLOCK(x, y))
+#define CELL_GRID_SIZE(size_x, size_y) (((long long)CELL_BLOCKS(size_x) * CELL_BLOCKS(size_y)) << (2 * CELL_BLOCK_BITS))
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC 0x53484950
+#define CHECKPOINT_VERSION 1
+#define MAX_FILENAME_LENGTH 1024
+
+static MPI_File openCheckpoint(char *, int);
+static MPI_Offset getShipsOffset(struct checkpoint_header_struct *);
+
+// Writes a checkpoint, every process must call this together. The header and port states (which must hold the state of
+// every port on every process) are written by process 0, and each process writes its own ships collectively straight after
+// those of the lower ranks. The file is written under a temporary name and renamed once complete, so that if the run is
+// killed part way through writing, the previous checkpoint is left intact. The number of ships in the header is filled in
+void writeCheckpoint(char *filename, struct checkpoint_header_struct *header, int *port_states, struct migrating_ship_struct *ships, int number_ships)
+{
+  int myrank;
+  char temporary_filename[MAX_FILENAME_LENGTH];
+  long long local_ships = number_ships, first_ship = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+  // The ships of each process follow on from those of the processes before it
+  MPI_Exscan(&local_ships, &first_ship, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+  if (myrank == 0)
+    first_ship = 0;
+  MPI_Allreduce(&local_ships, &header->number_ships, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+  header->magic = CHECKPOINT_MAGIC;
+  header->version = CHECKPOINT_VERSION;
+
+  snprintf(temporary_filename, MAX_FILENAME_LENGTH, "%s.tmp", filename);
+  MPI_File file = openCheckpoint(temporary_filename, MPI_MODE_CREATE | MPI_MODE_WRONLY);
+  MPI_File_set_size(file, 0);
+  if (myrank == 0)
+  {
+    MPI_File_write_at(file, 0, header, sizeof(struct checkpoint_header_struct), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_write_at(file, sizeof(struct checkpoint_header_struct), port_states, header->number_ports * header->port_state_size,
+                      MPI_INT, MPI_STATUS_IGNORE);
+  }
+  MPI_File_write_at_all(file, getShipsOffset(header) + first_ship * sizeof(struct migrating_ship_struct), ships, number_ships,
+                        getMigratingShipType(), MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+
+  if (myrank == 0 && rename(temporary_filename, filename) != 0)
+  {
+    fprintf(stderr, "Error, unable to rename the checkpoint '%s' to '%s'\n", temporary_filename, filename);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+}
+
+// Reads the header of a checkpoint, which process 0 reads and then broadcasts to the others. Every process must call this
+// together
+void readCheckpointHeader(char *filename, struct checkpoint_header_struct *header)
+{
+  int myrank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_File file = openCheckpoint(filename, MPI_MODE_RDONLY);
+  if (myrank == 0)
+    MPI_File_read_at(file, 0, header, sizeof(struct checkpoint_header_struct), MPI_BYTE, MPI_STATUS_IGNORE);
+  MPI_Bcast(header, sizeof(struct checkpoint_header_struct), MPI_BYTE, 0, MPI_COMM_WORLD);
+  MPI_File_close(&file);
+
+  if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION)
+  {
+    if (myrank == 0)
+      fprintf(stderr, "Error, '%s' is not a checkpoint written by this version of the simulation\n", filename);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+}
+
+// Reads the port states and ships from a checkpoint whose header has already been read, every process must call this
+// together. The state of every port is read into port_states on every process, whilst the ships are split evenly over the
+// processes as they might have been written by a different number of them. The ships read by this process are returned
+// via the ships pointer, which the caller must free, and the number of them is the return value
+int readCheckpoint(char *filename, struct checkpoint_header_struct *header, int *port_states, struct migrating_ship_struct **ships)
+{
+  int size, myrank;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  long long first_ship = (header->number_ships * myrank) / size;
+  int number_ships = (int)((header->number_ships * (myrank + 1)) / size - first_ship);
+
+  *ships = (struct migrating_ship_struct *)malloc(sizeof(struct migrating_ship_struct) * (number_ships > 0 ? number_ships : 1));
+  MPI_File file = openCheckpoint(filename, MPI_MODE_RDONLY);
+  MPI_File_read_at_all(file, sizeof(struct checkpoint_header_struct), port_states, header->number_ports * header->port_state_size,
+                       MPI_INT, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(file, getShipsOffset(header) + first_ship * sizeof(struct migrating_ship_struct), *ships, number_ships,
+                       getMigratingShipType(), MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+  return number_ships;
+}
+
+// Opens a checkpoint file collectively over every process with the access mode provided, aborting if this fails
+static MPI_File openCheckpoint(char *filename, int mode)
+{
+  MPI_File file;
+  if (MPI_File_open(MPI_COMM_WORLD, filename, mode, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+  {
+    fprintf(stderr, "Error, unable to open the checkpoint '%s'\n", filename);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+  return file;
+}
+
+// Returns the offset in bytes of the first ship in a checkpoint, which follows the header and the port states
+static MPI_Offset getShipsOffset(struct checkpoint_header_struct *header)
+{
+  return (MPI_Offset)sizeof(struct checkpoint_header_struct) + (MPI_Offset)header->number_ports * header->port_state_size * sizeof(int);
+}
@@ -0,0 +1,24 @@
+#ifndef CHECKPOINT_INCLUDE
+#define CHECKPOINT_INCLUDE
+
+#include "migration.h"
+
+// Description of the run held at the start of a checkpoint file
+// magic, version = identify the file as a checkpoint in the format written by this code
+// timestep = number of timesteps that had completed when the checkpoint was written, which the restart continues from
+// seed = seed of the random numbers, these are stateless so this and the timestep are all that is needed to continue them
+// size_x, size_y, number_ports = extent of the domain and number of ports, which must match the configuration on restart
+// port_state_size = number of integers packed for each port, which follow the header in order of port index
+// number_ships = number of ships, which follow the port states as packed migrating ships
+struct checkpoint_header_struct
+{
+  int magic, version;
+  int timestep, seed, size_x, size_y, number_ports, port_state_size;
+  long long number_ships;
+};
+
+void writeCheckpoint(char *, struct checkpoint_header_struct *, int *, struct migrating_ship_struct *, int);
+void readCheckpointHeader(char *, struct checkpoint_header_struct *);
+int readCheckpoint(char *, struct checkpoint_header_struct *, int *, struct migrating_ship_struct **);
+
+#endif
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "decomposition.h"
+
+// Only repartition when the busiest process has at least this much more work than the average, and when doing so would
+// reduce the work of the busiest part by at least this factor
+#define REBALANCE_THRESHOLD 1.1
+
+static void splitExtent(int, int, int *);
+static bool balanceExtent(long long *, int, int, int *);
+static long long getMaxPartWork(long long *, int, int *);
+static int findPart(int *, int, int);
+static void updateLocalExtent(struct decomposition_struct *);
+
+// Decomposes a global domain of size_x by size_y cells over all the processes. With one dimension the domain is cut
+// into strips along X only, with two dimensions MPI_Dims_create picks a balanced grid of blocks. Each process finds
+// its block, and its neighbours in all eight directions (diagonal neighbours are needed as ships move diagonally)
+void initialiseDecomposition(struct decomposition_struct *decomposition, int size_x, int size_y, int dimensions)
+{
+  int size, myrank;
+  int periods[2] = {0, 0};
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+  decomposition->dims[0] = 0;
+  decomposition->dims[1] = dimensions == 2 ? 0 : 1;
+  MPI_Dims_create(size, 2, decomposition->dims);
+  if (decomposition->dims[0] > size_x || decomposition->dims[1] > size_y)
+  {
+    if (myrank == 0)
+      fprintf(stderr, "Error, can not decompose a %d by %d domain over a %d by %d grid of processes\n", size_x, size_y,
+              decomposition->dims[0], decomposition->dims[1]);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+
+  // The ranks are not reordered so that they match MPI_COMM_WORLD, which the rest of the code communicates over
+  MPI_Cart_create(MPI_COMM_WORLD, 2, decomposition->dims, periods, 0, &decomposition->cart_comm);
+  MPI_Cart_coords(decomposition->cart_comm, myrank, 2, decomposition->coords);
+
+  decomposition->x_starts = (int *)malloc(sizeof(int) * (decomposition->dims[0] + 1));
+  decomposition->y_starts = (int *)malloc(sizeof(int) * (decomposition->dims[1] + 1));
+  splitExtent(size_x, decomposition->dims[0], decomposition->x_starts);
+  splitExtent(size_y, decomposition->dims[1], decomposition->y_starts);
+
+  updateLocalExtent(decomposition);
+
+  for (int dx = -1; dx <= 1; dx++)
+  {
+    for (int dy = -1; dy <= 1; dy++)
+    {
+      int neighbour_coords[2] = {decomposition->coords[0] + dx, decomposition->coords[1] + dy};
+      if ((dx == 0 && dy == 0) || neighbour_coords[0] < 0 || neighbour_coords[0] >= decomposition->dims[0] ||
+          neighbour_coords[1] < 0 || neighbour_coords[1] >= decomposition->dims[1])
+      {
+        decomposition->neighbours[NEIGHBOUR_INDEX(dx, dy)] = MPI_PROC_NULL;
+      }
+      else
+      {
+        MPI_Cart_rank(decomposition->cart_comm, neighbour_coords, &decomposition->neighbours[NEIGHBOUR_INDEX(dx, dy)]);
+      }
+    }
+  }
+}
+
+// Given the work measured in each column (X) and row (Y) of cells owned by this process, this decides whether the domain
+// should be repartitioned and if so moves the boundaries between processes so that each column and each row of processes
+// in the Cartesian grid has a similar share of the total work. Each process must own at least one cell in each dimension.
+// The neighbouring ranks do not change as the shape of the process grid stays the same. Returns whether the boundaries
+// have moved, in which case the owned extent of this process will have been updated
+bool rebalanceDecomposition(struct decomposition_struct *decomposition, long long *column_work, long long *row_work, int size_x, int size_y)
+{
+  int size;
+  long long local_work = 0, max_work, total_work;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  for (int i = 0; i < decomposition->local_nx; i++)
+    local_work += column_work[i];
+  MPI_Allreduce(&local_work, &max_work, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+  MPI_Allreduce(&local_work, &total_work, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+  if (total_work == 0 || max_work <= REBALANCE_THRESHOLD * ((double)total_work / size))
+    return false;
+
+  // Gather the work in every column and row of the global domain, each process contributing the cells it owns. The
+  // work of a column is summed over the Y extent of each process (and vice versa) so this is counted dims[1] times
+  // over, which does not affect where the balanced boundaries lie
+  long long *global_work = (long long *)calloc(size_x + size_y, sizeof(long long));
+  for (int i = 0; i < decomposition->local_nx; i++)
+    global_work[decomposition->basex + i] = column_work[i];
+  for (int i = 0; i < decomposition->local_ny; i++)
+    global_work[size_x + decomposition->basey + i] = row_work[i];
+  MPI_Allreduce(MPI_IN_PLACE, global_work, size_x + size_y, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+  bool x_changed = balanceExtent(global_work, size_x, decomposition->dims[0], decomposition->x_starts);
+  bool y_changed = balanceExtent(&global_work[size_x], size_y, decomposition->dims[1], decomposition->y_starts);
+  free(global_work);
+
+  updateLocalExtent(decomposition);
+  return x_changed || y_changed;
+}
+
+// Returns the rank of the process that owns the cell at global coordinates X and Y
+int getOwnerOfCell(struct decomposition_struct *decomposition, int x, int y)
+{
+  int rank;
+  int owner_coords[2];
+  owner_coords[0] = findPart(decomposition->x_starts, decomposition->dims[0], x);
+  owner_coords[1] = findPart(decomposition->y_starts, decomposition->dims[1], y);
+  MPI_Cart_rank(decomposition->cart_comm, owner_coords, &rank);
+  return rank;
+}
+
+// Frees the decomposition and its Cartesian communicator
+void finaliseDecomposition(struct decomposition_struct *decomposition)
+{
+  free(decomposition->x_starts);
+  free(decomposition->y_starts);
+  MPI_Comm_free(&decomposition->cart_comm);
+}
+
+// Splits an extent of n cells as evenly as possible over a number of parts, the first parts taking one more cell if
+// it does not divide exactly. The start of each part is written into starts, along with n as the final entry
+static void splitExtent(int n, int parts, int *starts)
+{
+  int part_size = n / parts;
+  int special_parts = n - part_size * parts;
+  for (int i = 0; i < parts; i++)
+  {
+    starts[i] = i < special_parts ? i * (part_size + 1) : special_parts * (part_size + 1) + (i - special_parts) * part_size;
+  }
+  starts[parts] = n;
+}
+
+// Given the work in each of the n cells along one dimension, this places the boundaries between parts so that each holds
+// as close as possible to an equal share of the work, whilst still holding at least one cell. The start of each part is
+// written into starts (which already holds the current boundaries), but only if this reduces the work of the busiest part
+// by more than REBALANCE_THRESHOLD, as moving the boundaries is expensive. Returns whether the boundaries moved
+static bool balanceExtent(long long *work, int n, int parts, int *starts)
+{
+  long long total = 0;
+  for (int i = 0; i < n; i++)
+    total += work[i];
+  if (total == 0 || parts == 1)
+    return false;
+
+  int *new_starts = (int *)malloc(sizeof(int) * (parts + 1));
+  long long prefix = 0;
+  int cell = 0;
+  new_starts[0] = 0;
+  new_starts[parts] = n;
+  for (int part = 1; part < parts; part++)
+  {
+    long long target = (total * part) / parts;
+    while (cell < n && prefix + work[cell] <= target)
+      prefix += work[cell++];
+    int start = cell;
+    if (start < new_starts[part - 1] + 1)
+      start = new_starts[part - 1] + 1;
+    if (start > n - (parts - part))
+      start = n - (parts - part);
+    new_starts[part] = start;
+  }
+
+  bool changed = REBALANCE_THRESHOLD * getMaxPartWork(work, parts, new_starts) < getMaxPartWork(work, parts, starts);
+  if (changed)
+  {
+    for (int part = 1; part < parts; part++)
+      starts[part] = new_starts[part];
+  }
+  free(new_starts);
+  return changed;
+}
+
+// Returns the work held by the busiest part, given the work in each cell and the starts of the parts along that dimension
+static long long getMaxPartWork(long long *work, int parts, int *starts)
+{
+  long long max_work = 0;
+  for (int part = 0; part < parts; part++)
+  {
+    long long part_work = 0;
+    for (int i = starts[part]; i < starts[part + 1]; i++)
+      part_work += work[i];
+    if (part_work > max_work)
+      max_work = part_work;
+  }
+  return max_work;
+}
+
+// Returns which part the cell at the coordinate provided falls within, given the starts of the parts along that dimension
+static int findPart(int *starts, int parts, int coordinate)
+{
+  int low = 0, high = parts - 1;
+  while (low < high)
+  {
+    int middle = (low + high + 1) / 2;
+    if (starts[middle] <= coordinate)
+      low = middle;
+    else
+      high = middle - 1;
+  }
+  return low;
+}
+
+// Sets the extent owned by this process from the boundaries between parts and its position in the process grid
+static void updateLocalExtent(struct decomposition_struct *decomposition)
+{
+  decomposition->basex = decomposition->x_starts[decomposition->coords[0]];
+  decomposition->basey = decomposition->y_starts[decomposition->coords[1]];
+  decomposition->local_nx = decomposition->x_starts[decomposition->coords[0] + 1] - decomposition->basex;
+  decomposition->local_ny = decomposition->y_starts[decomposition->coords[1] + 1] - decomposition->basey;
+}
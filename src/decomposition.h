@@ -0,0 +1,34 @@
+#ifndef DECOMPOSITION_INCLUDE
+#define DECOMPOSITION_INCLUDE
+
+#include <stdbool.h>
+#include "mpi.h"
+
+// Index into the neighbours array of the process in direction (dx, dy), where each of dx and dy is -1, 0 or 1
+#define NEIGHBOUR_INDEX(dx, dy) (((dx) + 1) * 3 + ((dy) + 1))
+#define NUMBER_NEIGHBOURS 9
+
+// Decomposition of the global domain into blocks, one per process, with the processes arranged as a Cartesian grid
+// cart_comm = Cartesian communicator over the processes, ranks are the same as in MPI_COMM_WORLD
+// dims = number of processes in the X and Y dimensions, coords = position of this process in the Cartesian grid
+// x_starts, y_starts = global coordinate where each column (row) of processes begins, with a final entry holding the
+// size of the domain in that dimension
+// basex, basey = global coordinates of the first cell owned by this process
+// local_nx, local_ny = number of cells owned by this process in each dimension
+// neighbours = rank of the process in each of the eight directions (see NEIGHBOUR_INDEX), MPI_PROC_NULL if there is
+// none, the centre entry is also MPI_PROC_NULL as a process never migrates ships to itself
+struct decomposition_struct
+{
+  MPI_Comm cart_comm;
+  int dims[2], coords[2];
+  int *x_starts, *y_starts;
+  int basex, basey, local_nx, local_ny;
+  int neighbours[NUMBER_NEIGHBOURS];
+};
+
+void initialiseDecomposition(struct decomposition_struct *, int, int, int);
+bool rebalanceDecomposition(struct decomposition_struct *, long long *, long long *, int, int);
+int getOwnerOfCell(struct decomposition_struct *, int, int);
+void finaliseDecomposition(struct decomposition_struct *);
+
+#endif
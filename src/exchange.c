@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "exchange.h"
+
+#define EXCHANGE_TAG 0
+#define EXCHANGE_OVERFLOW_TAG 1
+// Bytes at the start of each message holding the number of elements, which keeps the elements after it 8 byte aligned
+#define EXCHANGE_HEADER_SIZE 8
+
+static void reserveReceived(struct exchange_struct *, int);
+
+// Sets up an exchange of elements of element_size bytes with the neighbouring processes provided (MPI_PROC_NULL where
+// there is none), where up to capacity elements are sent in the single message to each neighbour. The persistent
+// requests are created here once, every process must call this together as the communicator is duplicated
+void initialiseExchange(struct exchange_struct *exchange, int number_neighbours, int *ranks, MPI_Comm comm, int element_size, int capacity)
+{
+  MPI_Comm_dup(comm, &exchange->comm);
+  exchange->number_neighbours = number_neighbours;
+  exchange->element_size = element_size;
+  exchange->capacity = capacity;
+  int slot_size = EXCHANGE_HEADER_SIZE + capacity * element_size;
+  exchange->neighbour_ranks = (int *)malloc(sizeof(int) * number_neighbours);
+  exchange->send_slots = (char *)calloc((size_t)number_neighbours, slot_size);
+  exchange->receive_slots = (char *)calloc((size_t)number_neighbours, slot_size);
+  exchange->requests = (MPI_Request *)malloc(sizeof(MPI_Request) * number_neighbours * 2);
+  exchange->overflow_requests = (MPI_Request *)malloc(sizeof(MPI_Request) * number_neighbours);
+  exchange->receive_counts = (int *)calloc(number_neighbours, sizeof(int));
+  exchange->received = NULL;
+  exchange->received_capacity = 0;
+  reserveReceived(exchange, capacity);
+
+  // Every receive is set up before the sends, so that starting them all at once posts the receives first
+  exchange->number_requests = 0;
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    exchange->neighbour_ranks[i] = ranks[i];
+    exchange->overflow_requests[i] = MPI_REQUEST_NULL;
+    if (ranks[i] != MPI_PROC_NULL)
+      MPI_Recv_init(&exchange->receive_slots[i * slot_size], slot_size, MPI_BYTE, ranks[i], EXCHANGE_TAG, exchange->comm,
+                    &exchange->requests[exchange->number_requests++]);
+  }
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    if (ranks[i] != MPI_PROC_NULL)
+      MPI_Send_init(&exchange->send_slots[i * slot_size], slot_size, MPI_BYTE, ranks[i], EXCHANGE_TAG, exchange->comm,
+                    &exchange->requests[exchange->number_requests++]);
+  }
+}
+
+// Starts exchanging the elements given for each neighbour (send_counts of them starting at send_data) without waiting for
+// this to complete. The elements are copied into the message to each neighbour, apart from any beyond its capacity which
+// are sent straight from send_data, so that must not change until finishExchange has been called
+void startExchange(struct exchange_struct *exchange, void **send_data, int *send_counts)
+{
+  int slot_size = EXCHANGE_HEADER_SIZE + exchange->capacity * exchange->element_size;
+  for (int i = 0; i < exchange->number_neighbours; i++)
+  {
+    if (exchange->neighbour_ranks[i] == MPI_PROC_NULL)
+      continue;
+    char *slot = &exchange->send_slots[i * slot_size];
+    int in_slot = send_counts[i] < exchange->capacity ? send_counts[i] : exchange->capacity;
+    memcpy(slot, &send_counts[i], sizeof(int));
+    if (in_slot > 0)
+      memcpy(&slot[EXCHANGE_HEADER_SIZE], send_data[i], (size_t)in_slot * exchange->element_size);
+    if (send_counts[i] > exchange->capacity)
+      MPI_Isend((char *)send_data[i] + (size_t)in_slot * exchange->element_size, (send_counts[i] - in_slot) * exchange->element_size,
+                MPI_BYTE, exchange->neighbour_ranks[i], EXCHANGE_OVERFLOW_TAG, exchange->comm, &exchange->overflow_requests[i]);
+  }
+  MPI_Startall(exchange->number_requests, exchange->requests);
+}
+
+// Waits for the exchange started by startExchange to complete. The elements received from every neighbour are returned
+// back to back in order of neighbour via the received pointer, which remains valid until the next exchange, with the
+// number from each neighbour in receive_counts. The total number of elements received is the return value
+int finishExchange(struct exchange_struct *exchange, void **received)
+{
+  int slot_size = EXCHANGE_HEADER_SIZE + exchange->capacity * exchange->element_size;
+  MPI_Waitall(exchange->number_requests, exchange->requests, MPI_STATUSES_IGNORE);
+  int total = 0;
+  for (int i = 0; i < exchange->number_neighbours; i++)
+  {
+    exchange->receive_counts[i] = 0;
+    if (exchange->neighbour_ranks[i] != MPI_PROC_NULL)
+      memcpy(&exchange->receive_counts[i], &exchange->receive_slots[i * slot_size], sizeof(int));
+    total += exchange->receive_counts[i];
+  }
+  reserveReceived(exchange, total);
+
+  // Elements beyond the capacity of a message follow it, as their number is now known they can be received directly
+  char *next = exchange->received;
+  for (int i = 0; i < exchange->number_neighbours; i++)
+  {
+    int in_slot = exchange->receive_counts[i] < exchange->capacity ? exchange->receive_counts[i] : exchange->capacity;
+    if (in_slot > 0)
+      memcpy(next, &exchange->receive_slots[i * slot_size + EXCHANGE_HEADER_SIZE], (size_t)in_slot * exchange->element_size);
+    next += (size_t)in_slot * exchange->element_size;
+    if (exchange->receive_counts[i] > exchange->capacity)
+    {
+      int overflow = exchange->receive_counts[i] - in_slot;
+      MPI_Recv(next, overflow * exchange->element_size, MPI_BYTE, exchange->neighbour_ranks[i], EXCHANGE_OVERFLOW_TAG,
+               exchange->comm, MPI_STATUS_IGNORE);
+      next += (size_t)overflow * exchange->element_size;
+    }
+  }
+  MPI_Waitall(exchange->number_neighbours, exchange->overflow_requests, MPI_STATUSES_IGNORE);
+
+  *received = exchange->received;
+  return total;
+}
+
+// Frees the persistent requests and buffers of an exchange, every process must call this together
+void finaliseExchange(struct exchange_struct *exchange)
+{
+  for (int i = 0; i < exchange->number_requests; i++)
+    MPI_Request_free(&exchange->requests[i]);
+  MPI_Comm_free(&exchange->comm);
+  free(exchange->neighbour_ranks);
+  free(exchange->send_slots);
+  free(exchange->receive_slots);
+  free(exchange->requests);
+  free(exchange->overflow_requests);
+  free(exchange->receive_counts);
+  free(exchange->received);
+}
+
+// Makes sure the buffer of received elements can hold the number of elements provided, growing it geometrically
+static void reserveReceived(struct exchange_struct *exchange, int number_elements)
+{
+  if (number_elements <= exchange->received_capacity)
+    return;
+  int new_capacity = exchange->received_capacity > 0 ? exchange->received_capacity : 64;
+  while (new_capacity < number_elements)
+    new_capacity *= 2;
+  exchange->received = (char *)realloc(exchange->received, (size_t)new_capacity * exchange->element_size);
+  if (exchange->received == NULL)
+  {
+    fprintf(stderr, "Error, unable to grow an exchange buffer to %d elements\n", new_capacity);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+  exchange->received_capacity = new_capacity;
+}
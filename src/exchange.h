@@ -0,0 +1,34 @@
+#ifndef EXCHANGE_INCLUDE
+#define EXCHANGE_INCLUDE
+
+#include "mpi.h"
+
+// A pattern of messages exchanged with a fixed set of neighbouring processes, which is set up once as persistent requests
+// and then started as many times as needed, so no requests are created or matched by probing in each exchange. Each
+// message carries a count followed by up to capacity elements, anything beyond this follows in a second message
+// comm = duplicate of the communicator given, so the exchange never matches other messages
+// number_neighbours, neighbour_ranks = the neighbours given, MPI_PROC_NULL where there is none in that direction
+// element_size, capacity = bytes in each element and the elements that fit in one message
+// send_slots, receive_slots = buffer of each message to and from each neighbour, a header holding the count and then
+// the elements, requests = the persistent receives followed by the persistent sends of the neighbours that exist
+// overflow_requests = sends of the elements that did not fit in the message to each neighbour
+// receive_counts = elements received from each neighbour, which are held back to back in order of neighbour in received
+// received_capacity = number of elements that received can hold, it grows as needed
+struct exchange_struct
+{
+  MPI_Comm comm;
+  int number_neighbours, *neighbour_ranks;
+  int element_size, capacity, number_requests;
+  char *send_slots, *receive_slots;
+  MPI_Request *requests, *overflow_requests;
+  int *receive_counts;
+  char *received;
+  int received_capacity;
+};
+
+void initialiseExchange(struct exchange_struct *, int, int *, MPI_Comm, int, int);
+void startExchange(struct exchange_struct *, void **, int *);
+int finishExchange(struct exchange_struct *, void **);
+void finaliseExchange(struct exchange_struct *);
+
+#endif
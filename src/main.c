@@ -1,27 +1,67 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <time.h>
 #include "simulation_configuration.h"
 #include "simulation_support.h"
 #include "route_map.h"
+#include "ship_pool.h"
+#include "cell_layout.h"
+#include "migration.h"
+#include "decomposition.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+#include "statistics.h"
+#include "performance.h"
 #include "mpi.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-#define MAX_SHIPS_PER_CELL 200
-#define ROUTE_PLANNER_TO_USE 0
+// Can be overridden when compiling, e.g. make CPPFLAGS="-DSIMULATION_TO_USE=1" for the overlapped simulation
+#ifndef SIMULATION_TO_USE
 #define SIMULATION_TO_USE 0
-
-// Data associated with each ship
-struct ship_struct
-{
-  int route, hoursAtSea, id, cargoAmount;
-  bool willMoveThisTimestep;
-};
-
-// Data associated with each port
+#endif
+// Number of integers packed for the state of one port when it moves between processes (cargo shipped, cargo arrived and
+// ships created), which are followed by the ships in port at each timestep of its window
+#define PORT_STATE_HEADER 3
+// Ports create ships based on the ships that have been in port over this many hours, sampled once per timestep
+#define PORT_WINDOW_HOURS 100
+// The creation of ships was written for the ships in port summed over ten timesteps of 10 hours each, so the total over
+// the window is scaled to this many samples whatever the number of hours per timestep
+#define PORT_WINDOW_SAMPLES 10
+// Number of totals gathered for each port in the final report (whether it is owned, cargo shipped and cargo arrived)
+#define FINAL_PORT_STATISTICS 3
+// Checkpoints are written to this file in the working directory, overwriting the previous one
+#define CHECKPOINT_FILENAME "ships.chk"
+// Telemetry is written to this file in the working directory, replacing that of any earlier run. A run restarted from a
+// checkpoint writes its rows to a file of its own instead, named after the timestep that it restarted from, so the rows
+// written before the restart are kept (read_telemetry joins the files back together)
+#define TELEMETRY_FILENAME "ships.tel"
+#define TELEMETRY_RESTART_FILENAME "ships_%d.tel"
+// The phase timers and counters of each process are written to this file in the working directory, if they are recorded
+#define PERFORMANCE_FILENAME "ships_perf.csv"
+// With more than one thread the sub_domain is split into this many tiles per thread, so threads that finish their tiles
+// early can pick up more work where ships are not spread evenly
+#define TILES_PER_THREAD 4
+// Which of the active cells a movement sweep visits
+#define VISIT_ALL_CELLS 0
+#define VISIT_BOUNDARY_CELLS 1
+#define VISIT_INTERIOR_CELLS 2
+// Ships at sea are updated in batches of this many slots of the ship pool, each batch is worked on by one thread at a time
+#define SHIP_BATCH_SIZE 1024
+
+// Data associated with each port owned by this process, which is held in the port table rather than in its cell
+// port_index=index of the port in the configuration
+// cell=sub_domain index of the cell that the port occupies
+// shipsCreated=number of ships this port has created, which gives each a unique id
+// shipsInWindow=ring buffer of the ships in port at each timestep of the window (port_window_size of them), the oldest
+// being at window_position, and shipsInPastHundredHours is their running total
 struct port_struct
 {
-  int shipsInPastHundredHours[10];
-  int port_index, cargoShipped, cargoArrived;
+  int port_index, cell, cargoShipped, cargoArrived, shipsCreated;
+  int *shipsInWindow;
+  int window_position, shipsInPastHundredHours;
 };
 
 // Each cell in the domain
@@ -30,126 +70,193 @@ struct port_struct
 // isWater=is the cell water (sea) that the ship can sail on
 // isPort=is the cell a port
 // isIsland=is the cell an island that must be avoided
+// first_ship=index in the ship pool of the first ship residing in this cell (-1 if empty), the rest follow via next_ship
 // number_ships=the number of ships that currently reside in this cell
+// isActive=is the cell held in the list of active cells that are visited each timestep
+// port=index in the port table of the port occupying this cell, -1 if it is not a port
 struct cell_struct
 {
   int x, y;
-  bool isWater, isPort, isIsland;
-  struct port_struct port_data;
-  struct ship_struct *ships_data[MAX_SHIPS_PER_CELL];
-  int number_ships;
+  bool isWater, isPort, isIsland, isActive;
+  int port;
+  int first_ship, number_ships;
+};
+
+// A ship leaving the tile it is in during a movement sweep, ship is its index in the ship pool. If neighbour is -1 the
+// ship is moving into local cell x, y of another tile, otherwise it is leaving for that neighbouring process and x, y
+// are the global coordinates of the cell it is moving into
+struct tile_move_struct
+{
+  int ship, neighbour, x, y;
+};
+
+// A tile of whole columns (first_column to last_column) of the sub_domain, worked on by one thread at a time
+// active_cells=dense list of the sub_domain indexes of cells in this tile that hold ships, plus its ports, so each
+// timestep only visits these. cells_to_visit is the number of them that were active at the start of the movement sweep
+// outbox=ships leaving this tile during a movement sweep, these are moved once every tile has been swept so that the
+// threads never touch another tile's cells (or the migration buffers and free list of the ship pool)
+struct tile_struct
+{
+  int first_column, last_column;
+  int *active_cells;
+  int number_active_cells, active_cells_capacity, cells_to_visit;
+  struct tile_move_struct *outbox;
+  int outbox_size, outbox_capacity;
 };
 
 // The domain in the serial version is divided into sub_domain in the parallel version
 struct cell_struct *sub_domain;
-int currentShipId = 0;
-int basex = 0;
-int size, myrank, nx, ny, local_nx;
-
-// Data type for defining ship
-MPI_Datatype shiptype;
+// The tiles that the sub_domain is split into, and the tile that each column belongs to (-1 for the halo columns)
+struct tile_struct *tiles;
+int number_tiles = 0;
+int *column_tiles;
+// The ports owned by this process, the ships in port over the window of each are held one after another in port_windows
+struct port_struct *port_table = NULL;
+int number_owned_ports = 0;
+int *port_windows = NULL;
+// Number of timesteps in the window of PORT_WINDOW_HOURS, which depends on the hours per timestep
+int port_window_size = 0;
+// Scratch list of the ships in a port, which processPort sorts by id
+int *port_ships = NULL;
+int port_ships_capacity = 0;
+int currentTimestep = 0;
+// Number of ships that this process has sent to other processes since the last report
+long long migratedShips = 0;
+// Checkpoint given on the command line to restart from (NULL to start from the beginning), and the first timestep to run
+char *restart_filename = NULL;
+int first_timestep = 0;
+// How ships are sent to the neighbouring processes, from the configuration
+int migration_mode = MIGRATION_TWO_SIDED;
+int basex = 0, basey = 0;
+int size, myrank, nx, ny, local_nx, local_ny;
+struct decomposition_struct decomposition;
+// Work (cells visited plus ships processed) in each owned column and row of cells since the last rebalance
+long long *column_work, *row_work;
 
 static void finalise_simulation();
-static void run_simulation(struct simulation_configuration_struct *, void (*)(int, int), void (*)(struct simulation_configuration_struct *), void (*)(struct simulation_configuration_struct *), void (*)(int, int, int, int *, int *), int (*)(struct cell_struct *), void (*)());
-static void run_route_planner(struct simulation_configuration_struct, int, int, int, int, int (*)(int, int, int, int));
+static void run_simulation(struct simulation_configuration_struct *, void (*)(int, int), void (*)(struct simulation_configuration_struct *), void (*)(struct simulation_configuration_struct *), void (*)(void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int)), void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int), void (*)());
+static void run_route_planner(struct simulation_configuration_struct, struct decomposition_struct *, int (*)(int, int, int, int));
 static void init_simulation(int, int);
 static void initialiseDomain(struct simulation_configuration_struct *);
-static void initialisePort(struct simulation_configuration_struct *, struct cell_struct *, int, int);
+static void buildSubDomain(struct simulation_configuration_struct *);
+static void initialisePort(struct simulation_configuration_struct *, struct port_struct *);
+static void rebalanceSubDomains(struct simulation_configuration_struct *);
+static int packShips(struct migrating_ship_struct *, bool);
+static int *packPortStates(struct simulation_configuration_struct *);
+static void unpackPortStates(int *);
+static int getPortStateSize();
+static void checkpointSimulation(struct simulation_configuration_struct *, int);
+static void restartFromCheckpoint(struct simulation_configuration_struct *);
+static void recordSimulationTelemetry();
 static void reportFinalInformation(struct simulation_configuration_struct *);
 static void updateProperties(struct simulation_configuration_struct *);
-static void updateMovement(struct simulation_configuration_struct *, void (*)(int, int, int, int *, int *), int (*)(struct cell_struct *));
-static void processPort(struct simulation_configuration_struct *, struct cell_struct *);
-static void processWater(struct cell_struct *, int);
-static int findFreeShipIndex(struct cell_struct *);
-static void reportStatistics(struct simulation_configuration_struct *, int);
-static void reportGeneralStatistics(struct simulation_configuration_struct *, int);
-static void perform_halo_swap(int, int, int, int, int);
-static void initializeHalos();
+#if SIMULATION_TO_USE == 0
+static void updateMovement(void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int));
+#elif SIMULATION_TO_USE == 1
+static void updateMovementOverlapped(void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int));
+#endif
+static void moveShipsInTiles(int, void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int));
+static int moveShipsInCell(struct tile_struct *, struct cell_struct *, void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int));
+static void addTileMove(struct tile_struct *, int, int, int, int);
+static void startMovementSweep();
+static void placeArrivingShips(struct migrating_ship_struct *, int, void (*)(struct cell_struct *, int));
+static bool isBoundaryCell(struct cell_struct *);
+static int getCellIndex(int, int);
+static void processPort(struct simulation_configuration_struct *, struct port_struct *);
+static void updateShipsAtSea(int);
+static int getNewShipId(struct simulation_configuration_struct *, struct port_struct *);
+static int compareShipIds(const void *, const void *);
+static void addShipToCell(struct cell_struct *, int);
+static void removeShipFromCell(struct cell_struct *, int);
+static void activateCell(struct cell_struct *);
+static void pruneActiveCells();
+static void initialiseTiles();
+static void finaliseTiles();
+static void reportGeneralStatistics(int);
 
 // Program entry point, loads up the configuration and runs the simulation
 int main(int argc, char *argv[])
 {
-  struct port_struct port;
-  struct ship_struct ship;
-  struct cell_struct cell;
-
   if (argc < 1)
   {
     fprintf(stderr, "You must provide the simulation configuration as an input parameter\n");
     return -1;
   }
 
-  // Initialize MPI
-  MPI_Init(&argc, &argv);
+  // Initialize MPI, only the main thread makes MPI calls
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
   MPI_Comm_size(MPI_COMM_WORLD, &size);
   MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
 
-  // Define derived data type for ship_struct
-  int length[5] = {1, 1, 1, 1, 1};
-  MPI_Aint disp[5], base;
-  MPI_Datatype type[5];
-
-  MPI_Get_address(&ship.route, &disp[0]);
-  MPI_Get_address(&ship.hoursAtSea, &disp[1]);
-  MPI_Get_address(&ship.id, &disp[2]);
-  MPI_Get_address(&ship.cargoAmount, &disp[3]);
-  MPI_Get_address(&ship.willMoveThisTimestep, &disp[4]);
-
-  base = disp[0];
-  disp[0] = disp[0] - base;
-  disp[1] = disp[1] - base;
-  disp[2] = disp[2] - base;
-  disp[3] = disp[3] - base;
-  disp[4] = disp[4] - base;
-
-  type[0] = MPI_INT;
-  type[1] = MPI_INT;
-  type[2] = MPI_INT;
-  type[3] = MPI_INT;
-  type[4] = MPI_C_BOOL;
-
-  // Commit the data type called shiptype
-  MPI_Type_create_struct(5, length, disp, type, &shiptype);
-  MPI_Type_commit(&shiptype);
-
   struct simulation_configuration_struct simulation_configuration;
-  parseConfiguration(argv[1], &simulation_configuration);
-
-  // calculate the size for sub_domain
-  nx = simulation_configuration.size_x;
-  ny = simulation_configuration.size_y;
-  local_nx = nx / size;
-
-  if (local_nx * size < nx)
+  // Only process 0 reads the configuration (in either the text or binary format), which it then sends to the others
+  if (myrank == 0)
+    readConfiguration(argv[1], &simulation_configuration);
+  broadcastConfiguration(&simulation_configuration, 0);
+  initialiseCellLookups(&simulation_configuration);
+  port_window_size = (PORT_WINDOW_HOURS + simulation_configuration.dt - 1) / simulation_configuration.dt;
+  // A checkpoint given after the configuration file restarts the run from it, with the seed that it was written with
+  if (argc > 2)
   {
-    int specialranks = nx - local_nx * size;
-    if (myrank < specialranks)
+    struct checkpoint_header_struct checkpoint_header;
+    restart_filename = argv[2];
+    readCheckpointHeader(restart_filename, &checkpoint_header);
+    if (checkpoint_header.size_x != simulation_configuration.size_x || checkpoint_header.size_y != simulation_configuration.size_y ||
+        checkpoint_header.number_ports != simulation_configuration.number_ports || checkpoint_header.port_state_size != getPortStateSize())
     {
-      local_nx++;
-      basex = myrank * local_nx;
-    }
-    else
-    {
-      basex = specialranks * (local_nx + 1) + (myrank - specialranks) * local_nx;
+      if (myrank == 0)
+        fprintf(stderr, "Error, the checkpoint '%s' was not written with this configuration\n", restart_filename);
+      MPI_Abort(MPI_COMM_WORLD, -1);
     }
+    simulation_configuration.seed = checkpoint_header.seed;
+    first_timestep = checkpoint_header.timestep;
   }
-  else
+  // Without a seed in the configuration one is picked from the clock, every process must use the same one
+  if (simulation_configuration.seed < 0)
   {
-    basex = myrank * local_nx;
+    simulation_configuration.seed = (int)(time(NULL) & 0x7fffffff);
+    MPI_Bcast(&simulation_configuration.seed, 1, MPI_INT, 0, MPI_COMM_WORLD);
   }
+  if (myrank == 0)
+    printf("The random seed is %d\n", simulation_configuration.seed);
+  initialisePerformance(simulation_configuration.performanceEvery);
+  migration_mode = simulation_configuration.migrationMode;
+#ifdef _OPENMP
+  // The number of threads per process comes from OMP_NUM_THREADS, unless it is set in the configuration
+  if (simulation_configuration.number_threads > 0)
+    omp_set_num_threads(simulation_configuration.number_threads);
+#endif
+
+  // calculate the size for sub_domain, which is either a strip along X or a 2D block depending on the configuration
+  nx = simulation_configuration.size_x;
+  ny = simulation_configuration.size_y;
+  initialiseDecomposition(&decomposition, nx, ny, simulation_configuration.decomposition_dimensions);
+  basex = decomposition.basex;
+  basey = decomposition.basey;
+  local_nx = decomposition.local_nx;
+  local_ny = decomposition.local_ny;
 
 // This is a resuable framework for route planner. If there are different ways of generating route, just add ROUTE_PLANNER_TO_USE
 // and write the corresponding function
 #if ROUTE_PLANNER_TO_USE == 0
-  run_route_planner(simulation_configuration, local_nx, myrank, size, basex, generate_route);
+  run_route_planner(simulation_configuration, &decomposition, generate_route);
+#elif ROUTE_PLANNER_TO_USE == 1
+  // Plans the shortest route between each pair of ports, with one search from each port shared by all of its routes
+  run_route_planner(simulation_configuration, &decomposition, generate_shortest_route);
 #endif
 
 // This is a framework to make the program reusable. If there are more ways of simulation, just add SIMULATION_TO_USE
 // and write the corresponding simualtion functions
 #if SIMULATION_TO_USE == 0
-  run_simulation(&simulation_configuration, init_simulation, initialiseDomain, updateProperties, getNextCell, findFreeShipIndex, finalise_simulation);
+  run_simulation(&simulation_configuration, init_simulation, initialiseDomain, updateProperties, updateMovement, getNextCell, addShipToCell, finalise_simulation);
+#elif SIMULATION_TO_USE == 1
+  // Overlaps the migration of ships between processes with the movement of ships in the interior of each sub_domain
+  run_simulation(&simulation_configuration, init_simulation, initialiseDomain, updateProperties, updateMovementOverlapped, getNextCell, addShipToCell, finalise_simulation);
 #endif
 
+  finalise_routemap();
+  finaliseDecomposition(&decomposition);
   MPI_Finalize();
   return 0;
 }
@@ -157,27 +264,44 @@ int main(int argc, char *argv[])
 // Decompose the domain and separate it into sub_domains for each process
 static void init_simulation(int mem_size_x, int mem_size_y)
 {
-  sub_domain = (struct cell_struct *)malloc(sizeof(struct cell_struct) * mem_size_x * mem_size_y);
+  sub_domain = (struct cell_struct *)malloc(sizeof(struct cell_struct) * CELL_GRID_SIZE(mem_size_x, mem_size_y));
+  initialiseShipPool(1024);
+  initialiseTiles();
+  column_work = (long long *)calloc(local_nx, sizeof(long long));
+  row_work = (long long *)calloc(local_ny, sizeof(long long));
+  initialiseMigration(NUMBER_NEIGHBOURS, decomposition.neighbours, MPI_COMM_WORLD, migration_mode);
+  initialiseStatistics();
 }
 
-// Free sub_domain
+// Free sub_domain and the ships held by this process
 static void finalise_simulation()
 {
   free(sub_domain);
+  finaliseTiles();
+  free(port_table);
+  free(port_windows);
+  free(port_ships);
+  free(column_work);
+  free(row_work);
+  finaliseShipPool();
+  finaliseMigration();
+  finaliseStatistics();
 }
 
 // start route planning
-static void run_route_planner(struct simulation_configuration_struct simulation_configuration, int local_nx, int myrank, int size, int basex, int (*generate_route_strategy)(int, int, int, int))
+static void run_route_planner(struct simulation_configuration_struct simulation_configuration, struct decomposition_struct *decomposition, int (*generate_route_strategy)(int, int, int, int))
 {
-  initialise_routemap(&simulation_configuration, local_nx, myrank, size, basex);
-  initialiseSimulationSupport();
+  initialise_routemap(&simulation_configuration, decomposition);
+  initialiseSimulationSupport(simulation_configuration.seed);
 
   // Parallelize the route planning and record the time
   MPI_Barrier(MPI_COMM_WORLD);
 
   double time1 = MPI_Wtime();
 
+  startTimer(TIMER_ROUTE_PLANNING);
   calculate_routes(&simulation_configuration, generate_route_strategy);
+  stopTimer(TIMER_ROUTE_PLANNING);
 
   MPI_Barrier(MPI_COMM_WORLD);
 
@@ -190,31 +314,81 @@ static void run_route_planner(struct simulation_configuration_struct simulation_
 }
 
 // Start simulation
-static void run_simulation(struct simulation_configuration_struct *simulation_configuration, void (*init_simulation)(int, int), void (*initialise_domain_strategy)(struct simulation_configuration_struct *), void (*update_properties_strategy)(struct simulation_configuration_struct *), void (*get_next_cell_strategy)(int, int, int, int *, int *), int (*find_fresh_index_strategy)(struct cell_struct *), void (*finalise_simulation)())
+static void run_simulation(struct simulation_configuration_struct *simulation_configuration, void (*init_simulation)(int, int), void (*initialise_domain_strategy)(struct simulation_configuration_struct *), void (*update_properties_strategy)(struct simulation_configuration_struct *), void (*update_movement_strategy)(void (*)(int, int, int, int, int *, int *), void (*)(struct cell_struct *, int)), void (*get_next_cell_strategy)(int, int, int, int, int *, int *), void (*add_ship_strategy)(struct cell_struct *, int), void (*finalise_simulation)())
 {
   int mem_size_x = local_nx + 2;
-  int mem_size_y = ny + 2;
+  int mem_size_y = local_ny + 2;
 
   init_simulation(mem_size_x, mem_size_y);
 
   MPI_Barrier(MPI_COMM_WORLD);
   double time1 = MPI_Wtime();
 
-  initialise_domain_strategy(simulation_configuration);
+  if (restart_filename != NULL)
+    restartFromCheckpoint(simulation_configuration);
+  else
+    initialise_domain_strategy(simulation_configuration);
 
-  int hours = 0;
+  int hours = first_timestep * simulation_configuration->dt;
+  if (simulation_configuration->telemetryEvery > 0)
+  {
+    char telemetry_filename[64];
+    if (restart_filename != NULL)
+      snprintf(telemetry_filename, sizeof(telemetry_filename), TELEMETRY_RESTART_FILENAME, first_timestep);
+    else
+      snprintf(telemetry_filename, sizeof(telemetry_filename), TELEMETRY_FILENAME);
+    initialiseTelemetry(telemetry_filename, simulation_configuration->number_ports, first_timestep, simulation_configuration->number_timesteps,
+                        simulation_configuration->telemetryEvery, simulation_configuration->dt);
+  }
 
   // Run the parallelized simulation - will loop through the configured number of timesteps
-  for (int i = 0; i < simulation_configuration->number_timesteps; i++)
+  for (int i = first_timestep; i < simulation_configuration->number_timesteps; i++)
   {
+    currentTimestep = i;
+    startTimer(TIMER_PROPERTIES);
     update_properties_strategy(simulation_configuration);
+    stopTimer(TIMER_PROPERTIES);
+
+    // The movement strategy times the movement of ships and their migration between processes itself
+    update_movement_strategy(get_next_cell_strategy, add_ship_strategy);
 
-    updateMovement(simulation_configuration, get_next_cell_strategy, find_fresh_index_strategy);
+    if (simulation_configuration->rebalanceEvery > 0 && (i + 1) % simulation_configuration->rebalanceEvery == 0)
+    {
+      startTimer(TIMER_REBALANCE);
+      rebalanceSubDomains(simulation_configuration);
+      stopTimer(TIMER_REBALANCE);
+    }
+
+    if (simulation_configuration->telemetryEvery > 0 && i % simulation_configuration->telemetryEvery == 0)
+    {
+      startTimer(TIMER_TELEMETRY);
+      recordSimulationTelemetry();
+      stopTimer(TIMER_TELEMETRY);
+    }
+
+    // The telemetry of this timestep is recorded before checkpointing, and every row recorded is in the file before the
+    // checkpoint is, so that a run restarted from it carries on from the next row without losing any
+    if (simulation_configuration->checkpointEvery > 0 && (i + 1) % simulation_configuration->checkpointEvery == 0)
+    {
+      startTimer(TIMER_CHECKPOINT);
+      if (simulation_configuration->telemetryEvery > 0)
+        flushTelemetry();
+      checkpointSimulation(simulation_configuration, i + 1);
+      stopTimer(TIMER_CHECKPOINT);
+    }
 
     if (i % simulation_configuration->reportStatsEvery == 0)
-      reportGeneralStatistics(simulation_configuration, hours);
+    {
+      startTimer(TIMER_REPORT);
+      reportGeneralStatistics(hours);
+      stopTimer(TIMER_REPORT);
+    }
+    completePerformanceStep(i);
     hours += simulation_configuration->dt; // Update the simulation hours by dt which is the number of hours per timestep
   }
+  if (simulation_configuration->telemetryEvery > 0)
+    finaliseTelemetry();
+  completeStatisticsReport();
   MPI_Barrier(MPI_COMM_WORLD);
   double time2 = MPI_Wtime();
 
@@ -224,468 +398,796 @@ static void run_simulation(struct simulation_configuration_struct *simulation_co
   }
 
   reportFinalInformation(simulation_configuration);
+  reportPerformance(PERFORMANCE_FILENAME);
 
   finalise_simulation();
 }
 
-// Reports the final information about the simulation when it is about to terminate
+// Reports the final information about the simulation when it is about to terminate. Every port is owned by at most one
+// process, so the totals of each are summed onto process 0 in a single reduction (ports that no process owns, as another
+// port occupies their cell or they are outside the domain, stay unowned) and are reported in order of port index
 static void reportFinalInformation(struct simulation_configuration_struct *simulation_configuration)
 {
-  int *statistics = NULL;
-  int len = 0;
-  MPI_Request request1, request2;
-  MPI_Status status;
-  if (myrank == 0)
+  int number_ports = simulation_configuration->number_ports;
+  int hours = simulation_configuration->dt * simulation_configuration->number_timesteps;
+  long long *statistics = (long long *)calloc(number_ports * FINAL_PORT_STATISTICS + 1, sizeof(long long));
+  for (int i = 0; i < number_owned_ports; i++)
   {
-    printf("======= Final report at %d hours =======\n", simulation_configuration->dt * simulation_configuration->number_timesteps);
-  }
-
-  for (int j = 1; j <= local_nx; j++)
-  {
-    for (int k = 1; k <= ny; k++)
-    {
-      struct cell_struct *specific_cell = &sub_domain[(j * (ny + 2)) + k];
-      if (specific_cell->isPort)
-      {
-        len += 3;
-        statistics = (int *)realloc(statistics, sizeof(int) * len);
-
-        statistics[len - 3] = specific_cell->port_data.port_index;
-        statistics[len - 2] = specific_cell->port_data.cargoShipped;
-        statistics[len - 1] = specific_cell->port_data.cargoArrived;
-
-        if (myrank == 0)
-        {
-          printf("Port %d shipped %d tonnes and %d arrived\n", specific_cell->port_data.port_index, specific_cell->port_data.cargoShipped, specific_cell->port_data.cargoArrived);
-        }
-      }
-    }
-  }
-  if (myrank != 0)
-  {
-    MPI_Isend(&len, 1, MPI_INT, 0, myrank, MPI_COMM_WORLD, &request1);
-    MPI_Isend(statistics, len, MPI_INT, 0, myrank, MPI_COMM_WORLD, &request2);
+    long long *port_statistics = &statistics[port_table[i].port_index * FINAL_PORT_STATISTICS];
+    port_statistics[0] = 1;
+    port_statistics[1] = port_table[i].cargoShipped;
+    port_statistics[2] = port_table[i].cargoArrived;
   }
+  if (myrank == 0)
+    MPI_Reduce(MPI_IN_PLACE, statistics, number_ports * FINAL_PORT_STATISTICS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
   else
+    MPI_Reduce(statistics, NULL, number_ports * FINAL_PORT_STATISTICS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if (myrank == 0)
   {
-    for (int i = 1; i < size; i++)
+    long long totalShipped = 0, totalArrived = 0;
+    printf("======= Final report at %d hours =======\n", hours);
+    for (int i = 0; i < number_ports; i++)
     {
-      MPI_Recv(&len, 1, MPI_INT, i, i, MPI_COMM_WORLD, &status);
-      if (len > 0)
-      {
-        int *receiver = (int *)malloc(sizeof(int) * len);
-        MPI_Recv(&receiver[0], len, MPI_INT, i, i, MPI_COMM_WORLD, &status);
-        for (int m = 0; m < len; m += 3)
-        {
-          printf("Port %d shipped %d tonnes and %d arrived\n", receiver[m], receiver[m + 1], receiver[m + 2]);
-        }
-      }
+      long long *port_statistics = &statistics[i * FINAL_PORT_STATISTICS];
+      if (port_statistics[0] == 0)
+        continue;
+      printf("Port %d shipped %lld tonnes and %lld arrived, %.2f and %.2f tonnes per hour\n", i, port_statistics[1], port_statistics[2],
+             hours > 0 ? (double)port_statistics[1] / hours : 0.0, hours > 0 ? (double)port_statistics[2] / hours : 0.0);
+      totalShipped += port_statistics[1];
+      totalArrived += port_statistics[2];
     }
+    printf("All ports shipped %lld tonnes and %lld arrived, %.2f and %.2f tonnes per hour\n", totalShipped, totalArrived,
+           hours > 0 ? (double)totalShipped / hours : 0.0, hours > 0 ? (double)totalArrived / hours : 0.0);
   }
+  free(statistics);
 }
 
 // Initialises the grid data structure based on the simulation configuration that has been read in
 static void initialiseDomain(struct simulation_configuration_struct *simulation_configuration)
 {
+  buildSubDomain(simulation_configuration);
+  // Every port starts off holding the initial ships
+  for (int i = 0; i < number_owned_ports; i++)
+  {
+    initialisePort(simulation_configuration, &port_table[i]);
+  }
+}
 
+// Sets up the empty cells of the sub_domain owned by this process, based on the simulation configuration, along with the
+// port table holding the ports that it owns
+static void buildSubDomain(struct simulation_configuration_struct *simulation_configuration)
+{
+  number_owned_ports = 0;
+  port_table = (struct port_struct *)realloc(port_table, sizeof(struct port_struct) * (simulation_configuration->number_ports + 1));
+  port_windows = (int *)realloc(port_windows, sizeof(int) * port_window_size * (simulation_configuration->number_ports + 1));
   for (int j = 1; j <= local_nx; j++)
   {
-    for (int k = 1; k <= ny; k++)
+    for (int k = 1; k <= local_ny; k++)
     {
-      sub_domain[(j * (ny + 2)) + k].x = j;
-      sub_domain[(j * (ny + 2)) + k].y = k;
-      for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
-      {
-        sub_domain[(j * (ny + 2)) + k].ships_data[z] = NULL;
-      }
+      struct cell_struct *specific_cell = &sub_domain[getCellIndex(j, k)];
+      specific_cell->x = j;
+      specific_cell->y = k;
+      specific_cell->first_ship = -1;
+      specific_cell->number_ships = 0;
+      specific_cell->isActive = false;
+      specific_cell->port = -1;
       // Now we set the type of grid cell based on the configuration
-      if (isCellAPort(simulation_configuration, basex + j - 1, k - 1))
+      if (isCellAPort(simulation_configuration, basex + j - 1, basey + k - 1))
       {
-        sub_domain[(j * (ny + 2)) + k].isPort = true;
-        sub_domain[(j * (ny + 2)) + k].isIsland = false;
-        sub_domain[(j * (ny + 2)) + k].isWater = false;
-        initialisePort(simulation_configuration, &sub_domain[(j * (ny + 2)) + k], basex + j - 1, k - 1);
+        specific_cell->isPort = true;
+        specific_cell->isIsland = false;
+        specific_cell->isWater = false;
+        specific_cell->port = number_owned_ports;
+        struct port_struct *port = &port_table[number_owned_ports];
+        port->port_index = getCellPortIndex(simulation_configuration, basex + j - 1, basey + k - 1);
+        port->cell = getCellIndex(j, k);
+        port->cargoArrived = 0;
+        port->cargoShipped = 0;
+        port->shipsCreated = 0;
+        port->shipsInWindow = &port_windows[number_owned_ports * port_window_size];
+        for (int i = 0; i < port_window_size; i++)
+          port->shipsInWindow[i] = 0;
+        port->window_position = 0;
+        port->shipsInPastHundredHours = 0;
+        number_owned_ports++;
+        // Ports are always active as they might create new ships even when empty
+        activateCell(specific_cell);
       }
-      else if (isCellAnIsland(simulation_configuration, basex + j - 1, k - 1))
+      else if (isCellAnIsland(simulation_configuration, basex + j - 1, basey + k - 1))
       {
-        sub_domain[(j * (ny + 2)) + k].isPort = false;
-        sub_domain[(j * (ny + 2)) + k].isIsland = true;
-        sub_domain[(j * (ny + 2)) + k].isWater = false;
-        sub_domain[(j * (ny + 2)) + k].number_ships = 0;
+        specific_cell->isPort = false;
+        specific_cell->isIsland = true;
+        specific_cell->isWater = false;
       }
       else
       {
-        sub_domain[(j * (ny + 2)) + k].isPort = false;
-        sub_domain[(j * (ny + 2)) + k].isIsland = false;
-        sub_domain[(j * (ny + 2)) + k].isWater = true;
-        sub_domain[(j * (ny + 2)) + k].number_ships = 0;
+        specific_cell->isPort = false;
+        specific_cell->isIsland = false;
+        specific_cell->isWater = true;
       }
     }
   }
 }
 
-// Initialises a single port in the domain based on the simulation configuration, the specific cell configuration, the X and Y coordinates
-static void initialisePort(struct simulation_configuration_struct *simulation_configuration, struct cell_struct *specific_cell, int x_coord, int y_coord)
+// Initialises a single port in the domain with its initial ships, based on the simulation configuration and the specific port
+static void initialisePort(struct simulation_configuration_struct *simulation_configuration, struct port_struct *port)
 {
-  specific_cell->port_data.port_index = getCellPortIndex(simulation_configuration, x_coord, y_coord);
+  struct cell_struct *specific_cell = &sub_domain[port->cell];
   for (int i = 0; i < simulation_configuration->initialShips; i++)
   {
-    struct ship_struct *newShip = (struct ship_struct *)malloc(sizeof(struct ship_struct));
-    newShip->hoursAtSea = 0;
-    newShip->cargoAmount = 0;
-    newShip->id = currentShipId++;
-    newShip->willMoveThisTimestep = true;
-    int currentPortIndex = specific_cell->port_data.port_index;
-    int targetPort = getTargetPort(simulation_configuration->number_ports, currentPortIndex);
-    newShip->route = simulation_configuration->ports[currentPortIndex].target_route_indexes[targetPort];
-    specific_cell->ships_data[i] = newShip;
+    int newShip = allocateShip();
+    ship_pool.hoursAtSea[newShip] = 0;
+    ship_pool.cargoAmount[newShip] = 0;
+    ship_pool.id[newShip] = getNewShipId(simulation_configuration, port);
+    ship_pool.willMoveThisTimestep[newShip] = true;
+    int currentPortIndex = port->port_index;
+    int targetPort = getTargetPort(simulation_configuration->number_ports, currentPortIndex, ship_pool.id[newShip], currentTimestep);
+    ship_pool.route[newShip] = simulation_configuration->ports[currentPortIndex].target_route_indexes[targetPort];
+    ship_pool.routeStep[newShip] = 0;
+    addShipToCell(specific_cell, newShip);
   }
-  specific_cell->number_ships = simulation_configuration->initialShips;
-  specific_cell->port_data.cargoArrived = 0;
-  specific_cell->port_data.cargoShipped = 0;
 }
 
-// Reports general statistics about the state of the simulation, called periodically during the simulation run
-static void reportGeneralStatistics(struct simulation_configuration_struct *simulation_configuration, int time)
+// Moves the boundaries between sub_domains so that each process has a similar amount of work, based on the work measured
+// in updateMovement since the last rebalance. If the boundaries move then the ships and port statistics are sent to the
+// processes that now own their cells, and the sub_domain and routes of this process are rebuilt for its new extent.
+// This is called at the end of a timestep, at which point no ship has a move pending
+static void rebalanceSubDomains(struct simulation_configuration_struct *simulation_configuration)
 {
-  int shipsAtSea = 0, shipsInPort = 0, cargoInTransit = 0;
-  int globalShipsAtSea, globalShipsInport, globalCargoTransit;
-  for (int j = 1; j <= local_nx; j++)
+  bool moved = rebalanceDecomposition(&decomposition, column_work, row_work, nx, ny);
+  if (!moved)
+  {
+    for (int i = 0; i < local_nx; i++)
+      column_work[i] = 0;
+    for (int i = 0; i < local_ny; i++)
+      row_work[i] = 0;
+    return;
+  }
+
+  // Pack every ship held by this process along with the process that now owns its cell, and the state of every port
+  struct migrating_ship_struct *ships = (struct migrating_ship_struct *)malloc(sizeof(struct migrating_ship_struct) * (ship_pool.number_ships + 1));
+  int *destinations = (int *)malloc(sizeof(int) * (ship_pool.number_ships + 1));
+  int number_ships = packShips(ships, true);
+  for (int i = 0; i < number_ships; i++)
+    destinations[i] = getOwnerOfCell(&decomposition, ships[i].x, ships[i].y);
+  int *port_states = packPortStates(simulation_configuration);
+
+  // Rebuild the sub_domain for the new extent of this process, the routes cover the whole domain so are unchanged
+  basex = decomposition.basex;
+  basey = decomposition.basey;
+  local_nx = decomposition.local_nx;
+  local_ny = decomposition.local_ny;
+  free(sub_domain);
+  sub_domain = (struct cell_struct *)malloc(sizeof(struct cell_struct) * CELL_GRID_SIZE(local_nx + 2, local_ny + 2));
+  finaliseTiles();
+  initialiseTiles();
+  buildSubDomain(simulation_configuration);
+  update_routemap_extent(&decomposition);
+
+  unpackPortStates(port_states);
+
+  // Send each ship to its new owner and place the ships that this process now owns
+  struct migrating_ship_struct *arrivals;
+  int number_arrivals = redistributeShips(ships, destinations, number_ships, &arrivals);
+  placeArrivingShips(arrivals, number_arrivals, addShipToCell);
+
+  free(ships);
+  free(destinations);
+  free(port_states);
+  free(column_work);
+  free(row_work);
+  column_work = (long long *)calloc(local_nx, sizeof(long long));
+  row_work = (long long *)calloc(local_ny, sizeof(long long));
+
+  if (myrank == 0)
+    printf("Rebalanced sub_domains, process 0 now owns %d by %d cells\n", local_nx, local_ny);
+}
+
+// Packs every ship held by this process, along with the global coordinates of the cell that it resides in, into the ships
+// array provided (which must have space for them all). If release is set then the ships are also removed from their cells
+// and the ship pool. Returns the number of ships packed
+static int packShips(struct migrating_ship_struct *ships, bool release)
+{
+  int number_ships = 0;
+  for (int t = 0; t < number_tiles; t++)
   {
-    for (int k = 1; k <= ny; k++)
+    for (int i = 0; i < tiles[t].number_active_cells; i++)
     {
-      struct cell_struct *specific_cell = &sub_domain[(j * (ny + 2)) + k];
-      if (specific_cell->isPort)
-        shipsInPort += specific_cell->number_ships;
-      if (specific_cell->isWater)
+      struct cell_struct *specific_cell = &sub_domain[tiles[t].active_cells[i]];
+      int shipIndex = specific_cell->first_ship;
+      while (shipIndex != -1)
       {
-        shipsAtSea += specific_cell->number_ships;
-        for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
+        int nextShip = ship_pool.next_ship[shipIndex];
+        ships[number_ships].route = ship_pool.route[shipIndex];
+        ships[number_ships].routeStep = ship_pool.routeStep[shipIndex];
+        ships[number_ships].hoursAtSea = ship_pool.hoursAtSea[shipIndex];
+        ships[number_ships].id = ship_pool.id[shipIndex];
+        ships[number_ships].cargoAmount = ship_pool.cargoAmount[shipIndex];
+        ships[number_ships].x = basex + specific_cell->x - 1;
+        ships[number_ships].y = basey + specific_cell->y - 1;
+        number_ships++;
+        if (release)
         {
-          if (specific_cell->ships_data[z] != NULL)
-            cargoInTransit += specific_cell->ships_data[z]->cargoAmount;
+          removeShipFromCell(specific_cell, shipIndex);
+          releaseShip(shipIndex);
         }
+        shipIndex = nextShip;
       }
     }
   }
-  MPI_Allreduce(&shipsAtSea, &globalShipsAtSea, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-  MPI_Allreduce(&shipsInPort, &globalShipsInport, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-  MPI_Allreduce(&cargoInTransit, &globalCargoTransit, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  return number_ships;
+}
 
-  if (myrank == 0)
+// Returns the state of every port, getPortStateSize() integers each in order of port index, which the caller must free.
+// Each process packs the ports that it owns and zeros for the rest, so summing over the processes gives the state of all
+// ports. The window of each port is packed from its oldest timestep, so the state does not depend on where its ring
+// buffer happens to start
+static int *packPortStates(struct simulation_configuration_struct *simulation_configuration)
+{
+  int port_state_size = getPortStateSize();
+  int *port_states = (int *)calloc(simulation_configuration->number_ports * port_state_size, sizeof(int));
+  for (int i = 0; i < number_owned_ports; i++)
   {
-    printf("======= Report at %d hours =======\n", time);
-    printf("%d ships at sea, %d ships in port, %d tonnes in transit\n", globalShipsAtSea, globalShipsInport, globalCargoTransit);
+    struct port_struct *port = &port_table[i];
+    int *port_state = &port_states[port->port_index * port_state_size];
+    port_state[0] = port->cargoShipped;
+    port_state[1] = port->cargoArrived;
+    port_state[2] = port->shipsCreated;
+    for (int z = 0; z < port_window_size; z++)
+      port_state[PORT_STATE_HEADER + z] = port->shipsInWindow[(port->window_position + z) % port_window_size];
   }
+  MPI_Allreduce(MPI_IN_PLACE, port_states, simulation_configuration->number_ports * port_state_size, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  return port_states;
 }
 
-// Updates the properties of the domain cells for a specific timestep, following the logic defined by the shipping company
-static void updateProperties(struct simulation_configuration_struct *simulation_configuration)
+// Sets the state of the ports owned by this process from the state of every port, as packed by packPortStates
+static void unpackPortStates(int *port_states)
 {
-  for (int j = 1; j <= local_nx; j++)
+  int port_state_size = getPortStateSize();
+  for (int i = 0; i < number_owned_ports; i++)
   {
-    for (int k = 1; k <= ny; k++)
+    struct port_struct *port = &port_table[i];
+    int *port_state = &port_states[port->port_index * port_state_size];
+    port->cargoShipped = port_state[0];
+    port->cargoArrived = port_state[1];
+    port->shipsCreated = port_state[2];
+    port->window_position = 0;
+    port->shipsInPastHundredHours = 0;
+    for (int z = 0; z < port_window_size; z++)
     {
-      struct cell_struct *specific_cell = &sub_domain[(j * (ny + 2)) + k];
-      if (specific_cell->isPort)
-      {
-        // If this is a port then perform port specific updates
-        processPort(simulation_configuration, specific_cell);
-      }
-      else if (specific_cell->isWater)
-      {
-        // If this is water then perform water specific updates
-        processWater(specific_cell, simulation_configuration->dt);
-      }
+      port->shipsInWindow[z] = port_state[PORT_STATE_HEADER + z];
+      port->shipsInPastHundredHours += port->shipsInWindow[z];
     }
   }
 }
 
-// Will update the moment of ships from a specific cell to their next one respectively
-static void updateMovement(struct simulation_configuration_struct *simulation_configuration, void (*get_next_cell_strategy)(int, int, int, int *, int *), int (*find_fresh_index_strategy)(struct cell_struct *))
+// Returns the number of integers packed for the state of each port, which depends on the number of timesteps in its window
+static int getPortStateSize()
 {
-  // Define the sending buffers, lengths of them and the positions of y
-  int len1 = 0;
-  struct ship_struct *sendShips1 = NULL;
-  int len2 = 0;
-  struct ship_struct *sendShips2 = NULL;
-  int *ys1 = NULL;
-  int *ys2 = NULL;
+  return PORT_STATE_HEADER + port_window_size;
+}
 
-  for (int j = 1; j <= local_nx; j++)
+// Writes the state of the simulation after a number of timesteps have completed to the checkpoint file. This is called at
+// the end of a timestep, at which point no ship has a move pending. The random numbers are stateless, so the seed and
+// timestep are all that is needed to continue them
+static void checkpointSimulation(struct simulation_configuration_struct *simulation_configuration, int timesteps_completed)
+{
+  struct checkpoint_header_struct header;
+  header.timestep = timesteps_completed;
+  header.seed = simulation_configuration->seed;
+  header.size_x = nx;
+  header.size_y = ny;
+  header.number_ports = simulation_configuration->number_ports;
+  header.port_state_size = getPortStateSize();
+
+  struct migrating_ship_struct *ships = (struct migrating_ship_struct *)malloc(sizeof(struct migrating_ship_struct) * (ship_pool.number_ships + 1));
+  int number_ships = packShips(ships, false);
+  int *port_states = packPortStates(simulation_configuration);
+  writeCheckpoint(CHECKPOINT_FILENAME, &header, port_states, ships, number_ships);
+  free(ships);
+  free(port_states);
+
+  if (myrank == 0)
+    printf("Checkpointed %lld ships at %d hours to %s\n", header.number_ships, timesteps_completed * simulation_configuration->dt, CHECKPOINT_FILENAME);
+}
+
+// Initialises the domain from the checkpoint given on the command line instead of from the configuration, which might
+// have been written by a different number of processes. The ships are read evenly over the processes and then sent to
+// the processes that own their cells
+static void restartFromCheckpoint(struct simulation_configuration_struct *simulation_configuration)
+{
+  struct checkpoint_header_struct header;
+  struct migrating_ship_struct *ships, *arrivals;
+  readCheckpointHeader(restart_filename, &header);
+  buildSubDomain(simulation_configuration);
+
+  int *port_states = (int *)malloc(sizeof(int) * header.number_ports * getPortStateSize());
+  int number_ships = readCheckpoint(restart_filename, &header, port_states, &ships);
+  unpackPortStates(port_states);
+
+  int *destinations = (int *)malloc(sizeof(int) * (number_ships + 1));
+  for (int i = 0; i < number_ships; i++)
+    destinations[i] = getOwnerOfCell(&decomposition, ships[i].x, ships[i].y);
+  int number_arrivals = redistributeShips(ships, destinations, number_ships, &arrivals);
+  placeArrivingShips(arrivals, number_arrivals, addShipToCell);
+  free(ships);
+  free(destinations);
+  free(port_states);
+
+  if (myrank == 0)
+    printf("Restarted %lld ships at %d hours from %s\n", header.number_ships, header.timestep * simulation_configuration->dt, restart_filename);
+}
+
+// Records the state of the ports owned by this process, and the number of ships at sea that it holds, in the telemetry.
+// Only the ports need visiting as every other ship is at sea
+static void recordSimulationTelemetry()
+{
+  int shipsInPort = 0;
+  for (int i = 0; i < number_owned_ports; i++)
+  {
+    struct port_struct *port = &port_table[i];
+    int shipsInThisPort = sub_domain[port->cell].number_ships;
+    recordTelemetryPort(port->port_index, shipsInThisPort, port->cargoShipped, port->cargoArrived);
+    shipsInPort += shipsInThisPort;
+  }
+  recordTelemetry(ship_pool.number_ships - shipsInPort);
+}
+
+// Reports general statistics about the state of the simulation, called periodically during the simulation run
+static void reportGeneralStatistics(int time)
+{
+  struct statistics_struct statistics = {0, 0, 0, 0, 0};
+  // Only the active cells can hold ships, so there is no need to visit the rest of the sub_domain
+  for (int t = 0; t < number_tiles; t++)
   {
-    for (int k = 1; k <= ny; k++)
+    for (int i = 0; i < tiles[t].number_active_cells; i++)
     {
-      struct cell_struct *specific_cell = &sub_domain[(j * (ny + 2)) + k];
-      // Loop through all the possible ships in this cell
-      for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
+      struct cell_struct *specific_cell = &sub_domain[tiles[t].active_cells[i]];
+      if (specific_cell->isPort)
+        statistics.shipsInPort += specific_cell->number_ships;
+      if (specific_cell->isWater)
       {
-        if (specific_cell->ships_data[z] != NULL && specific_cell->ships_data[z]->willMoveThisTimestep)
-        {
-          int newX, newY;
-          // Asks the route planner for the next cell to move to based on the route this ship is following and the
-          // current X and Y location of the ship. This is returned via the newX and newY pointers
-          get_next_cell_strategy(specific_cell->ships_data[z]->route, basex + specific_cell->x - 1, specific_cell->y - 1, &newX, &newY);
-
-          specific_cell->ships_data[z]->willMoveThisTimestep = false;
-
-          // If next cell is on the bottom boundary of sub_domain, save the ship in the first sending buffer
-          if (j + newX == local_nx + 1)
-          {
-            len1++;
-            sendShips1 = (struct ship_struct *)realloc(sendShips1, sizeof(struct ship_struct) * len1);
-            ys1 = (int *)realloc(ys1, sizeof(int) * len1);
-
-            sendShips1[len1 - 1].id = specific_cell->ships_data[z]->id;
-            sendShips1[len1 - 1].hoursAtSea = specific_cell->ships_data[z]->hoursAtSea;
-            sendShips1[len1 - 1].cargoAmount = specific_cell->ships_data[z]->cargoAmount;
-            sendShips1[len1 - 1].route = specific_cell->ships_data[z]->route;
-            sendShips1[len1 - 1].willMoveThisTimestep = specific_cell->ships_data[z]->willMoveThisTimestep;
-
-            ys1[len1 - 1] = k + newY;
-
-            specific_cell->ships_data[z] = NULL;
-            specific_cell->number_ships--;
-          }
-          else if (j + newX == 0) // If next cell is on the top boundary of sub_domain, save the ship in the second sending buffer
-          {
-            len2++;
-            sendShips2 = (struct ship_struct *)realloc(sendShips2, sizeof(struct ship_struct) * len2);
-            ys2 = (int *)realloc(ys2, sizeof(int) * len2);
-
-            sendShips2[len2 - 1].id = specific_cell->ships_data[z]->id;
-            sendShips2[len2 - 1].hoursAtSea = specific_cell->ships_data[z]->hoursAtSea;
-            sendShips2[len2 - 1].cargoAmount = specific_cell->ships_data[z]->cargoAmount;
-            sendShips2[len2 - 1].route = specific_cell->ships_data[z]->route;
-            sendShips2[len2 - 1].willMoveThisTimestep = specific_cell->ships_data[z]->willMoveThisTimestep;
-
-            ys2[len2 - 1] = k + newY;
-
-            specific_cell->ships_data[z] = NULL;
-            specific_cell->number_ships--;
-          }
-          else // Otherwise update it in its own area
-          {
-            int newIndex = find_fresh_index_strategy(&sub_domain[((j + newX) * (ny + 2)) + k + newY]);
-            if (newIndex > -1)
-            {
-              sub_domain[((j + newX) * (ny + 2)) + k + newY].ships_data[newIndex] = specific_cell->ships_data[z];
-              specific_cell->ships_data[z] = NULL;
-              specific_cell->number_ships--;
-              sub_domain[((j + newX) * (ny + 2)) + k + newY].number_ships++;
-            }
-          }
-        }
+        statistics.shipsAtSea += specific_cell->number_ships;
+        for (int shipIndex = specific_cell->first_ship; shipIndex != -1; shipIndex = ship_pool.next_ship[shipIndex])
+          statistics.cargoInTransit += ship_pool.cargoAmount[shipIndex];
       }
+      if (specific_cell->number_ships > statistics.maxShipsInCell)
+        statistics.maxShipsInCell = specific_cell->number_ships;
     }
   }
+  statistics.migratingShips = migratedShips;
+  migratedShips = 0;
+  // The statistics of every process are combined in the background and printed at the next report
+  startStatisticsReport(&statistics, time);
+}
 
-  MPI_Request requests[] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL};
-
-  // If the first sending buffer is not empty, send it to the next neighboring process
-  if (len1 > 0)
+// Updates the properties of the domain cells for a specific timestep, following the logic defined by the shipping company.
+// The ships at sea are updated straight from the ship pool in parallel batches. Ports create and remove ships, which
+// changes the ship pool, so they are updated one after another once the ships at sea are complete
+static void updateProperties(struct simulation_configuration_struct *simulation_configuration)
+{
+  updateShipsAtSea(simulation_configuration->dt);
+  for (int i = 0; i < number_owned_ports; i++)
   {
-    if (myrank < size - 1)
-    {
-      MPI_Isend(&len1, 1, MPI_INT, myrank + 1, myrank, MPI_COMM_WORLD, &requests[0]);
+    // Perform port specific updates
+    processPort(simulation_configuration, &port_table[i]);
+  }
+}
+
+#if SIMULATION_TO_USE == 0
+// Will update the moment of ships from a specific cell to their next one respectively
+static void updateMovement(void (*get_next_cell_strategy)(int, int, int, int, int *, int *), void (*add_ship_strategy)(struct cell_struct *, int))
+{
+  startTimer(TIMER_MOVEMENT);
+  startMovementSweep();
+  moveShipsInTiles(VISIT_ALL_CELLS, get_next_cell_strategy, add_ship_strategy);
+  stopTimer(TIMER_MOVEMENT);
+
+  // Exchange the migrating ships with the neighbouring processes, then place the arrivals
+  startTimer(TIMER_MIGRATION);
+  struct migrating_ship_struct *arrivals;
+  int number_arrivals = exchangeMigratingShips(&arrivals);
+  placeArrivingShips(arrivals, number_arrivals, add_ship_strategy);
+  stopTimer(TIMER_MIGRATION);
+
+  // Cells that ships have left are dropped from the active list once the sweep is complete
+  startTimer(TIMER_MOVEMENT);
+  pruneActiveCells();
+  stopTimer(TIMER_MOVEMENT);
+}
+#elif SIMULATION_TO_USE == 1
+// Updates the movement of ships as updateMovement does, but overlaps the migration of ships with computation. As ships
+// move at most one cell per timestep only ships in the cells on the edge of the sub_domain can leave it, so these cells
+// are processed first and the migrating ships sent. The interior cells are then processed whilst these messages are in
+// flight, and the arriving ships are received and placed at the end
+static void updateMovementOverlapped(void (*get_next_cell_strategy)(int, int, int, int, int *, int *), void (*add_ship_strategy)(struct cell_struct *, int))
+{
+  startTimer(TIMER_MOVEMENT);
+  startMovementSweep();
+  moveShipsInTiles(VISIT_BOUNDARY_CELLS, get_next_cell_strategy, add_ship_strategy);
+  stopTimer(TIMER_MOVEMENT);
+
+  startTimer(TIMER_MIGRATION);
+  startMigratingShipExchange();
+  stopTimer(TIMER_MIGRATION);
+
+  // Ships that moved into interior cells above are not moved again as they are already marked as having moved
+  startTimer(TIMER_MOVEMENT);
+  moveShipsInTiles(VISIT_INTERIOR_CELLS, get_next_cell_strategy, add_ship_strategy);
+  stopTimer(TIMER_MOVEMENT);
+
+  startTimer(TIMER_MIGRATION);
+  struct migrating_ship_struct *arrivals;
+  int number_arrivals = finishMigratingShipExchange(&arrivals);
+  placeArrivingShips(arrivals, number_arrivals, add_ship_strategy);
+  stopTimer(TIMER_MIGRATION);
+
+  startTimer(TIMER_MOVEMENT);
+  pruneActiveCells();
+  stopTimer(TIMER_MOVEMENT);
+}
+#endif
 
-      MPI_Isend(&sendShips1[0], len1, shiptype, myrank + 1, myrank, MPI_COMM_WORLD, &requests[1]);
+// Marks the start of a movement sweep. Only the cells that were active at this point are visited, cells that ships move
+// into are appended to the active lists but their ships have already moved this timestep
+static void startMovementSweep()
+{
+  for (int t = 0; t < number_tiles; t++)
+    tiles[t].cells_to_visit = tiles[t].number_active_cells;
+}
 
-      MPI_Isend(&ys1[0], len1, MPI_INT, myrank + 1, myrank, MPI_COMM_WORLD, &requests[2]);
-    }
-  }
-  else if (len1 == 0) // Otherwise send the length 0 to the next neighboring process
+// Moves the ships in the active cells of every tile (either all of them, or just those on or off the edge of the sub_domain)
+// with the tiles shared between the threads. Each tile collects the ships leaving it in its outbox, and once every tile
+// is done these are moved into the other tiles or queued for migration to the neighbouring processes, in order of tile
+static void moveShipsInTiles(int cells_to_move, void (*get_next_cell_strategy)(int, int, int, int, int *, int *), void (*add_ship_strategy)(struct cell_struct *, int))
+{
+  long long shipsMoved = 0, shipsMigrated = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : shipsMoved)
+  for (int t = 0; t < number_tiles; t++)
   {
-    if (myrank < size - 1)
+    for (int i = 0; i < tiles[t].cells_to_visit; i++)
     {
-      MPI_Isend(&len1, 1, MPI_INT, myrank + 1, myrank, MPI_COMM_WORLD, &requests[0]);
+      struct cell_struct *specific_cell = &sub_domain[tiles[t].active_cells[i]];
+      if (cells_to_move == VISIT_ALL_CELLS || (cells_to_move == VISIT_BOUNDARY_CELLS) == isBoundaryCell(specific_cell))
+        shipsMoved += moveShipsInCell(&tiles[t], specific_cell, get_next_cell_strategy, add_ship_strategy);
     }
   }
 
-  // If the second sending buffer is not empty, send it to the previous neighboring process
-  if (len2 > 0)
+  for (int t = 0; t < number_tiles; t++)
   {
-    if (myrank > 0)
+    for (int i = 0; i < tiles[t].outbox_size; i++)
     {
-      MPI_Isend(&len2, 1, MPI_INT, myrank - 1, myrank, MPI_COMM_WORLD, &requests[3]);
-
-      MPI_Isend(&sendShips2[0], len2, shiptype, myrank - 1, myrank, MPI_COMM_WORLD, &requests[4]);
-
-      MPI_Isend(&ys2[0], len2, MPI_INT, myrank - 1, myrank, MPI_COMM_WORLD, &requests[5]);
+      struct tile_move_struct *move = &tiles[t].outbox[i];
+      if (move->neighbour == -1)
+      {
+        add_ship_strategy(&sub_domain[getCellIndex(move->x, move->y)], move->ship);
+      }
+      else
+      {
+        struct migrating_ship_struct migrating_ship;
+        migrating_ship.route = ship_pool.route[move->ship];
+        migrating_ship.routeStep = ship_pool.routeStep[move->ship];
+        migrating_ship.hoursAtSea = ship_pool.hoursAtSea[move->ship];
+        migrating_ship.id = ship_pool.id[move->ship];
+        migrating_ship.cargoAmount = ship_pool.cargoAmount[move->ship];
+        migrating_ship.x = move->x;
+        migrating_ship.y = move->y;
+        queueMigratingShip(move->neighbour, &migrating_ship);
+        shipsMigrated++;
+        releaseShip(move->ship);
+      }
     }
+    tiles[t].outbox_size = 0;
   }
-  else if (len2 == 0) // Otherwise send the length 0 to the previous neighboring process
+  migratedShips += shipsMigrated;
+  addToCounter(COUNTER_SHIPS_MOVED, shipsMoved);
+  addToCounter(COUNTER_SHIPS_MIGRATED, shipsMigrated);
+}
+
+// Moves each ship in a specific cell of a tile that is due to move this timestep into its next cell. Ships moving within
+// the tile are placed straight away, whereas ships leaving the tile (or the sub_domain) are put in the tile's outbox.
+// Returns the number of ships moved
+static int moveShipsInCell(struct tile_struct *tile, struct cell_struct *specific_cell, void (*get_next_cell_strategy)(int, int, int, int, int *, int *), void (*add_ship_strategy)(struct cell_struct *, int))
+{
+  int j = specific_cell->x;
+  int k = specific_cell->y;
+  // Each column belongs to a single tile, but rows are shared between the tiles
+  column_work[j - 1] += 1 + specific_cell->number_ships;
+#pragma omp atomic
+  row_work[k - 1] += 1 + specific_cell->number_ships;
+  // Loop through the ships in this cell, the next ship is looked up first as this one might leave the cell
+  int shipsMoved = 0;
+  int shipIndex = specific_cell->first_ship;
+  while (shipIndex != -1)
   {
-    if (myrank > 0)
+    int nextShip = ship_pool.next_ship[shipIndex];
+    if (ship_pool.willMoveThisTimestep[shipIndex])
     {
-      MPI_Isend(&len2, 1, MPI_INT, myrank - 1, myrank, MPI_COMM_WORLD, &requests[3]);
+      int newX, newY;
+      // Asks the route planner for the next cell to move to based on the route this ship is following, how far along
+      // it the ship is and the current X and Y location of the ship. This is returned via the newX and newY pointers
+      get_next_cell_strategy(ship_pool.route[shipIndex], ship_pool.routeStep[shipIndex], basex + specific_cell->x - 1, basey + specific_cell->y - 1, &newX, &newY);
+
+      ship_pool.willMoveThisTimestep[shipIndex] = false;
+      ship_pool.routeStep[shipIndex]++;
+      shipsMoved++;
+
+      // If next cell is on the boundary of sub_domain then the ship will be packed, along with the global coordinates of
+      // the cell it is moving into, in the migration buffer of the neighbouring process that owns that cell. This might be
+      // a diagonal neighbour if the ship is leaving through a corner
+      int direction_x = j + newX == 0 ? -1 : (j + newX == local_nx + 1 ? 1 : 0);
+      int direction_y = k + newY == 0 ? -1 : (k + newY == local_ny + 1 ? 1 : 0);
+      removeShipFromCell(specific_cell, shipIndex);
+      if (direction_x != 0 || direction_y != 0)
+      {
+        addTileMove(tile, shipIndex, NEIGHBOUR_INDEX(direction_x, direction_y), basex + j + newX - 1, basey + k + newY - 1);
+      }
+      else if (&tiles[column_tiles[j + newX]] != tile)
+      {
+        addTileMove(tile, shipIndex, -1, j + newX, k + newY);
+      }
+      else // Otherwise update it in its own area
+      {
+        add_ship_strategy(&sub_domain[getCellIndex(j + newX, k + newY)], shipIndex);
+      }
     }
+    shipIndex = nextShip;
   }
+  return shipsMoved;
+}
 
-  // Define the receiving buffers
-  struct ship_struct *receiveShips1 = NULL;
-  struct ship_struct *receiveShips2 = NULL;
-  int *receiveys1 = NULL;
-  int *receiveys2 = NULL;
-  int cell_amount = 0;
-  MPI_Status status;
-
-  // Cells in the boundary receive messages
-  if (myrank < size - 1)
+// Adds a ship leaving a tile to its outbox, see tile_move_struct for the meaning of neighbour, x and y
+static void addTileMove(struct tile_struct *tile, int ship, int neighbour, int x, int y)
+{
+  if (tile->outbox_size == tile->outbox_capacity)
   {
-    MPI_Recv(&cell_amount, 1, MPI_INT, myrank + 1, myrank + 1, MPI_COMM_WORLD, &status);
-
-    // If the amount of cells is above 0, receive them and update them to the sub_domain
-    if (cell_amount > 0)
-    {
-      receiveShips1 = (struct ship_struct *)malloc(sizeof(struct ship_struct) * cell_amount * 100000);
-      receiveys1 = (int *)realloc(receiveys1, sizeof(int) * cell_amount * 10000);
-
-      MPI_Recv(&receiveShips1[0], cell_amount, shiptype, myrank + 1, myrank + 1, MPI_COMM_WORLD, &status);
+    tile->outbox_capacity *= 2;
+    tile->outbox = (struct tile_move_struct *)realloc(tile->outbox, sizeof(struct tile_move_struct) * tile->outbox_capacity);
+  }
+  tile->outbox[tile->outbox_size].ship = ship;
+  tile->outbox[tile->outbox_size].neighbour = neighbour;
+  tile->outbox[tile->outbox_size].x = x;
+  tile->outbox[tile->outbox_size].y = y;
+  tile->outbox_size++;
+}
 
-      MPI_Recv(&receiveys1[0], cell_amount, MPI_INT, myrank + 1, myrank + 1, MPI_COMM_WORLD, &status);
+// Copies each ship that has migrated to this process into the ship pool and places it in the cell it has moved into
+static void placeArrivingShips(struct migrating_ship_struct *arrivals, int number_arrivals, void (*add_ship_strategy)(struct cell_struct *, int))
+{
+  for (int i = 0; i < number_arrivals; i++)
+  {
+    int newShip = allocateShip();
+    ship_pool.route[newShip] = arrivals[i].route;
+    ship_pool.routeStep[newShip] = arrivals[i].routeStep;
+    ship_pool.hoursAtSea[newShip] = arrivals[i].hoursAtSea;
+    ship_pool.id[newShip] = arrivals[i].id;
+    ship_pool.cargoAmount[newShip] = arrivals[i].cargoAmount;
+    add_ship_strategy(&sub_domain[getCellIndex(arrivals[i].x - basex + 1, arrivals[i].y - basey + 1)], newShip);
+  }
+}
 
-      for (int j = 0; j < cell_amount; j++)
-      {
-        int y = receiveys1[j];
+// Returns whether a specific cell is on the edge of the sub_domain, in which case ships in it might leave this process
+static bool isBoundaryCell(struct cell_struct *specific_cell)
+{
+  return specific_cell->x == 1 || specific_cell->x == local_nx || specific_cell->y == 1 || specific_cell->y == local_ny;
+}
 
-        int newIndex = find_fresh_index_strategy(&sub_domain[local_nx * (ny + 2) + y]);
-        if (newIndex > -1)
-        {
-          sub_domain[local_nx * (ny + 2) + y].ships_data[newIndex] = &receiveShips1[j];
+// Returns the index in the sub_domain of the cell at local X and Y coordinates (the halo being 0 and local_nx + 1 or
+// local_ny + 1), which depends on the layout of the cells in memory selected by CELL_LAYOUT_TO_USE
+static int getCellIndex(int x, int y)
+{
+  return (int)CELL_INDEX(x, y, local_ny + 2);
+}
 
-          sub_domain[local_nx * (ny + 2) + y].number_ships++;
-        }
-      }
-    }
+// Port specific processing for a timestep, given the simulation configuration and the specific port from the port table
+// this function will perform the necessary updates as per the behaviour defined by the shipping company.
+static void processPort(struct simulation_configuration_struct *simulation_configuration, struct port_struct *port)
+{
+  struct cell_struct *specific_cell = &sub_domain[port->cell];
+  // The ships in port now replace the oldest timestep of the window, which keeps the running total of the past hundred
+  // hours without summing the window again
+  port->shipsInPastHundredHours += specific_cell->number_ships - port->shipsInWindow[port->window_position];
+  port->shipsInWindow[port->window_position] = specific_cell->number_ships;
+  port->window_position = (port->window_position + 1) % port_window_size;
+  int totalShips = (port->shipsInPastHundredHours * PORT_WINDOW_SAMPLES) / port_window_size;
+  // Having calculated the total number of ships in the past hundred hours, let's see if we need to create a new one
+  if (shouldCreateNewShip(totalShips, port->port_index, currentTimestep))
+  {
+    // Create a new ship and initialise values, then store it in the port
+    int newShip = allocateShip();
+    ship_pool.hoursAtSea[newShip] = 0;
+    ship_pool.cargoAmount[newShip] = 0;
+    ship_pool.id[newShip] = getNewShipId(simulation_configuration, port);
+    addShipToCell(specific_cell, newShip);
+    addToCounter(COUNTER_SHIPS_CREATED, 1);
   }
-
-  if (myrank > 0)
+  // Now handle each ship in port. The order that ships arrive depends on how the domain is decomposed, and whether a ship
+  // is removed depends on how many are left, so they are handled in order of id to give the same result on any decomposition
+  if (specific_cell->number_ships > port_ships_capacity)
   {
-    MPI_Recv(&cell_amount, 1, MPI_INT, myrank - 1, myrank - 1, MPI_COMM_WORLD, &status);
-
-    // If the amount of cells is above 0, receive them and update them to the sub_domain
-    if (cell_amount > 0)
+    port_ships_capacity = specific_cell->number_ships * 2;
+    port_ships = (int *)realloc(port_ships, sizeof(int) * port_ships_capacity);
+  }
+  int number_port_ships = 0;
+  for (int shipIndex = specific_cell->first_ship; shipIndex != -1; shipIndex = ship_pool.next_ship[shipIndex])
+    port_ships[number_port_ships++] = shipIndex;
+  qsort(port_ships, number_port_ships, sizeof(int), compareShipIds);
+  for (int i = 0; i < number_port_ships; i++)
+  {
+    int shipIndex = port_ships[i];
+    // Update arrived cargo in port
+    port->cargoArrived += ship_pool.cargoAmount[shipIndex];
+    if (specific_cell->number_ships > 1 && shouldRemoveShip(ship_pool.hoursAtSea[shipIndex], ship_pool.id[shipIndex], currentTimestep))
     {
-      receiveShips2 = (struct ship_struct *)malloc(sizeof(struct ship_struct) * cell_amount * 100000);
-      receiveys2 = (int *)realloc(receiveys2, sizeof(int) * cell_amount * 10000);
-
-      MPI_Recv(&receiveShips2[0], cell_amount, shiptype, myrank - 1, myrank - 1, MPI_COMM_WORLD, &status);
-
-      MPI_Recv(&receiveys2[0], cell_amount, MPI_INT, myrank - 1, myrank - 1, MPI_COMM_WORLD, &status);
+      // If we have more than one ship in port and we should remove this one then eliminate it
+      removeShipFromCell(specific_cell, shipIndex);
+      releaseShip(shipIndex);
+      addToCounter(COUNTER_SHIPS_REMOVED, 1);
+    }
+    else
+    {
+      // Figure out where ship should move to (the target port) and assign cargo to it. Note that the cargo assignment is very simple as
+      // a specific port will load up the same amount of cargo for each ship (and the specific amount for each port is defined in the
+      // configuration file)
+      ship_pool.willMoveThisTimestep[shipIndex] = true;
+      int currentPortIndex = port->port_index;
+      int targetPort = getTargetPort(simulation_configuration->number_ports, currentPortIndex, ship_pool.id[shipIndex], currentTimestep);
+      ship_pool.route[shipIndex] = simulation_configuration->ports[currentPortIndex].target_route_indexes[targetPort];
+      ship_pool.routeStep[shipIndex] = 0;
+      ship_pool.cargoAmount[shipIndex] = simulation_configuration->ports[currentPortIndex].cargo;
+      port->cargoShipped += ship_pool.cargoAmount[shipIndex];
+    }
+  }
+}
 
-      for (int j = 0; j < cell_amount; j++)
-      {
-        int y = receiveys2[j];
+// Returns the id for a new ship created by a specific port. Ids are numbered by port, so they do not depend on which
+// process owns the port, which keeps the random numbers drawn for each ship the same on any decomposition
+static int getNewShipId(struct simulation_configuration_struct *simulation_configuration, struct port_struct *port)
+{
+  return port->shipsCreated++ * simulation_configuration->number_ports + port->port_index;
+}
 
-        int newIndex = find_fresh_index_strategy(&sub_domain[ny + 2 + y]);
-        if (newIndex > -1)
-        {
+// Orders ship pool indexes by the id of the ship, for qsort
+static int compareShipIds(const void *a, const void *b)
+{
+  int first = ship_pool.id[*(const int *)a], second = ship_pool.id[*(const int *)b];
+  return (first > second) - (first < second);
+}
 
-          sub_domain[ny + 2 + y].ships_data[newIndex] = &receiveShips2[j];
-          sub_domain[ny + 2 + y].number_ships++;
-        }
-      }
+// Updates every ship residing in a water cell for a specific timestep, where dt is the number of hours that each timestep
+// represents. Rather than following the ships of each cell, the slots of the ship pool are worked through in batches so
+// that each array is read and written contiguously and the move decisions of a batch are made at once by willShipsMove.
+// Slots not in use, and ships in ports, are given a count of zero ships in their cell, which leaves them unchanged
+static void updateShipsAtSea(int dt)
+{
+#pragma omp parallel for schedule(static)
+  for (int first = 0; first < ship_pool.high_water_mark; first += SHIP_BATCH_SIZE)
+  {
+    int number = ship_pool.high_water_mark - first < SHIP_BATCH_SIZE ? ship_pool.high_water_mark - first : SHIP_BATCH_SIZE;
+    int shipsInCell[SHIP_BATCH_SIZE];
+    bool willMove[SHIP_BATCH_SIZE];
+    for (int i = 0; i < number; i++)
+    {
+      int cell = ship_pool.cell[first + i];
+      shipsInCell[i] = cell != -1 && sub_domain[cell].isWater ? sub_domain[cell].number_ships : 0;
+    }
+    willShipsMove(number, shipsInCell, &ship_pool.id[first], currentTimestep, willMove);
+#pragma omp simd
+    for (int i = 0; i < number; i++)
+    {
+      bool atSea = shipsInCell[i] > 0;
+      ship_pool.hoursAtSea[first + i] += atSea ? dt : 0;
+      ship_pool.willMoveThisTimestep[first + i] |= atSea && willMove[i];
     }
   }
+}
 
-  MPI_Waitall(6, requests, MPI_STATUSES_IGNORE);
+// Places a ship from the ship pool into a specific cell, both port and water cells need to store ships from one timestep
+// to the next. The ship is chained onto the front of the cell's list of ships
+static void addShipToCell(struct cell_struct *specific_cell, int ship)
+{
+  ship_pool.cell[ship] = (int)(specific_cell - sub_domain);
+  ship_pool.previous_ship[ship] = -1;
+  ship_pool.next_ship[ship] = specific_cell->first_ship;
+  if (specific_cell->first_ship != -1)
+    ship_pool.previous_ship[specific_cell->first_ship] = ship;
+  specific_cell->first_ship = ship;
+  specific_cell->number_ships++;
+  if (!specific_cell->isActive)
+    activateCell(specific_cell);
+}
 
-  if (sendShips1 != NULL)
-    free(sendShips1);
-  if (sendShips2 != NULL)
-    free(sendShips2);
-  if (ys1 != NULL)
-    free(ys1);
-  if (ys2 != NULL)
-    free(ys2);
+// Unlinks a ship from the list of ships residing in a specific cell, the ship itself stays in the ship pool
+static void removeShipFromCell(struct cell_struct *specific_cell, int ship)
+{
+  if (ship_pool.previous_ship[ship] != -1)
+    ship_pool.next_ship[ship_pool.previous_ship[ship]] = ship_pool.next_ship[ship];
+  else
+    specific_cell->first_ship = ship_pool.next_ship[ship];
+  if (ship_pool.next_ship[ship] != -1)
+    ship_pool.previous_ship[ship_pool.next_ship[ship]] = ship_pool.previous_ship[ship];
+  ship_pool.next_ship[ship] = -1;
+  ship_pool.previous_ship[ship] = -1;
+  specific_cell->number_ships--;
 }
 
-// Port specific processing for a timestep, given the simulation configuration and the specific cell data structure that represents this port
-// this function will perform the necessary updates as per the behaviour defined by the shipping company.
-static void processPort(struct simulation_configuration_struct *simulation_configuration, struct cell_struct *specific_cell)
+// Appends a cell to the list of active cells of its tile, which are visited each timestep
+static void activateCell(struct cell_struct *specific_cell)
 {
-  int totalShips = 0;
-  for (int i = 0; i < 9; i++)
+  struct tile_struct *tile = &tiles[column_tiles[specific_cell->x]];
+  if (tile->number_active_cells == tile->active_cells_capacity)
   {
-    // This assumes that we have DT of 10, hence working back the past 10 timesteps. This is an OK assumption to make if you
-    // want to keep it simple
-    specific_cell->port_data.shipsInPastHundredHours[i] = specific_cell->port_data.shipsInPastHundredHours[i + 1];
-    totalShips += specific_cell->port_data.shipsInPastHundredHours[i];
+    tile->active_cells_capacity *= 2;
+    tile->active_cells = (int *)realloc(tile->active_cells, sizeof(int) * tile->active_cells_capacity);
   }
-  specific_cell->port_data.shipsInPastHundredHours[9] = specific_cell->number_ships;
-  totalShips += specific_cell->number_ships;
-  // Having calculated the total number of ships in the past hundred hours, let's see if we need to create a new one
-  if (shouldCreateNewShip(totalShips))
-  {
-    // Create a new ship and initialise values
-    struct ship_struct *newShip = (struct ship_struct *)malloc(sizeof(struct ship_struct));
-    newShip->hoursAtSea = 0;
-    newShip->cargoAmount = 0;
-    newShip->id = currentShipId++;
-    // Finds a free index in the ports data structure to store this new ship
-    int nextIndex = findFreeShipIndex(specific_cell);
-    if (nextIndex > -1)
-    {
-      specific_cell->ships_data[nextIndex] = newShip;
-      specific_cell->number_ships++;
-    }
-  }
-  // Now loop through each possible ship in port and handle it
-  for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
+  tile->active_cells[tile->number_active_cells++] = (int)(specific_cell - sub_domain);
+  specific_cell->isActive = true;
+}
+
+// Removes the water cells that no longer hold any ships from the lists of active cells, ports always stay active. This
+// is done once the movement sweep has completed so that the lists are not reordered whilst they are being walked
+static void pruneActiveCells()
+{
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int t = 0; t < number_tiles; t++)
   {
-    if (specific_cell->ships_data[z] != NULL)
+    int kept = 0;
+    for (int i = 0; i < tiles[t].number_active_cells; i++)
     {
-      // Update arrived cargo in port
-      specific_cell->port_data.cargoArrived += specific_cell->ships_data[z]->cargoAmount;
-      if (specific_cell->number_ships > 1 && shouldRemoveShip(specific_cell->ships_data[z]->hoursAtSea))
+      struct cell_struct *specific_cell = &sub_domain[tiles[t].active_cells[i]];
+      if (specific_cell->isPort || specific_cell->number_ships > 0)
       {
-        // If we have more than one ship in port and we should remove this one then eliminate it
-        specific_cell->ships_data[z] = NULL;
-        specific_cell->number_ships--;
+        tiles[t].active_cells[kept++] = tiles[t].active_cells[i];
       }
       else
       {
-        // Figure out where ship should move to (the target port) and assign cargo to it. Note that the cargo assignment is very simple as
-        // a specific port will load up the same amount of cargo for each ship (and the specific amount for each port is defined in the
-        // configuration file)
-        specific_cell->ships_data[z]->willMoveThisTimestep = true;
-        int currentPortIndex = specific_cell->port_data.port_index;
-        int targetPort = getTargetPort(simulation_configuration->number_ports, currentPortIndex);
-        specific_cell->ships_data[z]->route = simulation_configuration->ports[currentPortIndex].target_route_indexes[targetPort];
-        specific_cell->ships_data[z]->cargoAmount = simulation_configuration->ports[currentPortIndex].cargo;
-        specific_cell->port_data.cargoShipped += specific_cell->ships_data[z]->cargoAmount;
+        specific_cell->isActive = false;
       }
     }
+    tiles[t].number_active_cells = kept;
   }
 }
 
-// Process a grid cell per timestep if it is water. As well as the specific cell, also pass in dt which is the number
-// of hours that each timestep represents
-static void processWater(struct cell_struct *specific_cell, int dt)
+// Splits the columns of the sub_domain into tiles of (as near as possible) equal width, each starting with no active
+// cells. A single thread works on the whole sub_domain as one tile
+static void initialiseTiles()
 {
-  // Loop through each possible ship in the water cell and update its properties
-  for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
+  number_tiles = 1;
+#ifdef _OPENMP
+  if (omp_get_max_threads() > 1)
+    number_tiles = omp_get_max_threads() * TILES_PER_THREAD;
+#endif
+  if (number_tiles > local_nx)
+    number_tiles = local_nx;
+  tiles = (struct tile_struct *)malloc(sizeof(struct tile_struct) * number_tiles);
+  column_tiles = (int *)malloc(sizeof(int) * (local_nx + 2));
+  column_tiles[0] = -1;
+  column_tiles[local_nx + 1] = -1;
+  for (int t = 0; t < number_tiles; t++)
   {
-    if (specific_cell->ships_data[z] != NULL)
-    {
-      if (willShipMove(specific_cell->number_ships))
-      {
-        specific_cell->ships_data[z]->willMoveThisTimestep = true;
-      }
-      specific_cell->ships_data[z]->hoursAtSea += dt;
-    }
+    tiles[t].first_column = 1 + (int)(((long long)local_nx * t) / number_tiles);
+    tiles[t].last_column = (int)(((long long)local_nx * (t + 1)) / number_tiles);
+    for (int j = tiles[t].first_column; j <= tiles[t].last_column; j++)
+      column_tiles[j] = t;
+    tiles[t].active_cells_capacity = 1024;
+    tiles[t].active_cells = (int *)malloc(sizeof(int) * tiles[t].active_cells_capacity);
+    tiles[t].number_active_cells = 0;
+    tiles[t].cells_to_visit = 0;
+    tiles[t].outbox_capacity = 64;
+    tiles[t].outbox = (struct tile_move_struct *)malloc(sizeof(struct tile_move_struct) * tiles[t].outbox_capacity);
+    tiles[t].outbox_size = 0;
   }
 }
 
-// Given the data structure that stores a specific cell, this will identify the index of the first free location that
-// a ship can be stored in, both port and water cells need to store ships from one timestep to the next
-static int findFreeShipIndex(struct cell_struct *specific_cell)
+// Frees the tiles and their lists
+static void finaliseTiles()
 {
-  for (int z = 0; z < MAX_SHIPS_PER_CELL; z++)
+  for (int t = 0; t < number_tiles; t++)
   {
-    if (specific_cell->ships_data[z] == NULL)
-      return z;
+    free(tiles[t].active_cells);
+    free(tiles[t].outbox);
   }
-  return -1;
+  free(tiles);
+  free(column_tiles);
 }
@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "migration.h"
+#include "exchange.h"
+#include "performance.h"
+
+// Ships that fit in the single message sent to each neighbour every timestep, any more follow in a second message
+#define MIGRATION_MESSAGE_SHIPS 32
+// Ships that fit in the region of an inbox for each neighbour when migrating one sided, any more follow in a message
+#define INBOX_REGION_SHIPS 256
+#define INBOX_OVERFLOW_TAG 1
+
+// Ships waiting to be sent to one neighbouring process, these buffers live for the whole simulation and only ever grow
+struct migration_buffer_struct
+{
+  struct migrating_ship_struct *ships;
+  int number_ships, capacity;
+};
+
+static int number_neighbours;
+static int *neighbour_ranks; // Rank of each neighbour, MPI_PROC_NULL where there is no neighbour in that direction
+static MPI_Comm migration_comm;
+static MPI_Datatype migrating_ship_type;
+static int migration_mode;
+// Exchange of ships with the neighbours when migrating two sided, which is set up once and reused every timestep
+static struct exchange_struct ship_exchange;
+static void **send_data;
+static int *send_counts;
+// Inbox of this process when migrating one sided, exposed as a window to the neighbours. It starts with the number of
+// ships put by the neighbour in each direction (padded to inbox_header_size bytes), followed by a region of
+// INBOX_REGION_SHIPS ships for each direction. The neighbours that exist form neighbour_group, which both puts into this
+// inbox and is put into by this process, and overflow_requests are the sends of ships that did not fit in an inbox
+static MPI_Win inbox_window;
+static char *inbox;
+static int inbox_header_size;
+static MPI_Group neighbour_group;
+static MPI_Request *overflow_requests;
+
+static struct migration_buffer_struct *send_buffers; // One send buffer per neighbour
+static struct migration_buffer_struct receive_buffer; // Ships redistributed from all processes are received into here
+
+static void reserveMigrationBuffer(struct migration_buffer_struct *, int);
+static void initialiseInbox(MPI_Comm);
+static void startOneSidedExchange();
+static void finishOneSidedExchange();
+
+// Sets up the migration buffers and the exchange of ships with the neighbouring processes provided (in the order of
+// NEIGHBOUR_INDEX), in the migration mode given, along with the derived data type for a packed ship. Every process must
+// call this together
+void initialiseMigration(int neighbours, int *ranks, MPI_Comm comm, int mode)
+{
+  struct migrating_ship_struct ship;
+  int myrank;
+  MPI_Comm_rank(comm, &myrank);
+  if (mode != MIGRATION_TWO_SIDED && mode != MIGRATION_ONE_SIDED)
+  {
+    if (myrank == 0)
+      fprintf(stderr, "Error, the migration mode %d is not known, it must be %d (two sided) or %d (one sided)\n", mode,
+              MIGRATION_TWO_SIDED, MIGRATION_ONE_SIDED);
+    MPI_Abort(comm, -1);
+  }
+  migration_mode = mode;
+  number_neighbours = neighbours;
+  migration_comm = comm;
+  neighbour_ranks = (int *)malloc(sizeof(int) * number_neighbours);
+  send_data = (void **)malloc(sizeof(void *) * number_neighbours);
+  send_counts = (int *)malloc(sizeof(int) * number_neighbours);
+  send_buffers = (struct migration_buffer_struct *)malloc(sizeof(struct migration_buffer_struct) * number_neighbours);
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    neighbour_ranks[i] = ranks[i];
+    send_buffers[i].ships = NULL;
+    send_buffers[i].number_ships = 0;
+    send_buffers[i].capacity = 0;
+    reserveMigrationBuffer(&send_buffers[i], 64);
+  }
+  receive_buffer.ships = NULL;
+  receive_buffer.number_ships = 0;
+  receive_buffer.capacity = 0;
+  reserveMigrationBuffer(&receive_buffer, 64);
+  if (migration_mode == MIGRATION_TWO_SIDED)
+    initialiseExchange(&ship_exchange, number_neighbours, ranks, comm, sizeof(struct migrating_ship_struct), MIGRATION_MESSAGE_SHIPS);
+  else
+    initialiseInbox(comm);
+
+  // Define derived data type for migrating_ship_struct
+  int length[7] = {1, 1, 1, 1, 1, 1, 1};
+  MPI_Aint disp[7], base;
+  MPI_Datatype type[7] = {MPI_INT, MPI_INT, MPI_INT, MPI_INT, MPI_INT, MPI_INT, MPI_INT};
+
+  MPI_Get_address(&ship.route, &disp[0]);
+  MPI_Get_address(&ship.routeStep, &disp[1]);
+  MPI_Get_address(&ship.hoursAtSea, &disp[2]);
+  MPI_Get_address(&ship.id, &disp[3]);
+  MPI_Get_address(&ship.cargoAmount, &disp[4]);
+  MPI_Get_address(&ship.x, &disp[5]);
+  MPI_Get_address(&ship.y, &disp[6]);
+
+  base = disp[0];
+  for (int i = 0; i < 7; i++)
+    disp[i] = disp[i] - base;
+
+  MPI_Type_create_struct(7, length, disp, type, &migrating_ship_type);
+  MPI_Type_commit(&migrating_ship_type);
+}
+
+// Adds a ship to the buffer of ships that will be sent to a specific neighbour at the next exchange
+void queueMigratingShip(int neighbour, struct migrating_ship_struct *ship)
+{
+  struct migration_buffer_struct *buffer = &send_buffers[neighbour];
+  if (buffer->number_ships == buffer->capacity)
+    reserveMigrationBuffer(buffer, buffer->number_ships + 1);
+  buffer->ships[buffer->number_ships++] = *ship;
+}
+
+// Sends the queued ships to every neighbour (even if no ships are queued) and receives the ships sent to this process in
+// return. The arrivals are returned via the arrivals pointer, which remains valid until
+// the next exchange, and the number of them is the return value
+int exchangeMigratingShips(struct migrating_ship_struct **arrivals)
+{
+  startMigratingShipExchange();
+  return finishMigratingShipExchange(arrivals);
+}
+
+// Starts the exchange of the queued ships with every neighbour without waiting for it, so that other work can be done
+// while the messages are in flight. No more ships can be queued until finishMigratingShipExchange has been called
+void startMigratingShipExchange()
+{
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    send_data[i] = send_buffers[i].ships;
+    send_counts[i] = send_buffers[i].number_ships;
+    if (neighbour_ranks[i] != MPI_PROC_NULL)
+      addToCounter(COUNTER_BYTES_SENT, (long long)send_buffers[i].number_ships * sizeof(struct migrating_ship_struct));
+  }
+  if (migration_mode == MIGRATION_TWO_SIDED)
+    startExchange(&ship_exchange, send_data, send_counts);
+  else
+    startOneSidedExchange();
+}
+
+// Receives the ships sent to this process by every neighbour and completes the sends started by
+// startMigratingShipExchange. The arrivals are returned as with exchangeMigratingShips
+int finishMigratingShipExchange(struct migrating_ship_struct **arrivals)
+{
+  int number_arrivals;
+  if (migration_mode == MIGRATION_TWO_SIDED)
+  {
+    number_arrivals = finishExchange(&ship_exchange, (void **)arrivals);
+  }
+  else
+  {
+    finishOneSidedExchange();
+    *arrivals = receive_buffer.ships;
+    number_arrivals = receive_buffer.number_ships;
+  }
+  for (int i = 0; i < number_neighbours; i++)
+    send_buffers[i].number_ships = 0;
+  return number_arrivals;
+}
+
+// Sends each of the ships provided to the process given by its entry in destinations, which can be any process rather
+// than just a neighbour. Every process must call this together, it is used when the decomposition changes and ships have
+// to move to their new owners. The arrivals are returned as with exchangeMigratingShips
+int redistributeShips(struct migrating_ship_struct *ships, int *destinations, int number_ships, struct migrating_ship_struct **arrivals)
+{
+  int size, myrank;
+  MPI_Comm_size(migration_comm, &size);
+  MPI_Comm_rank(migration_comm, &myrank);
+  int *send_counts = (int *)calloc(size, sizeof(int));
+  int *send_displacements = (int *)malloc(sizeof(int) * size);
+  int *receive_counts = (int *)malloc(sizeof(int) * size);
+  int *receive_displacements = (int *)malloc(sizeof(int) * size);
+  struct migrating_ship_struct *sorted_ships = (struct migrating_ship_struct *)malloc(sizeof(struct migrating_ship_struct) * (number_ships > 0 ? number_ships : 1));
+
+  // Order the ships by destination so that the ships for each process are contiguous
+  for (int i = 0; i < number_ships; i++)
+    send_counts[destinations[i]]++;
+  send_displacements[0] = 0;
+  for (int i = 1; i < size; i++)
+    send_displacements[i] = send_displacements[i - 1] + send_counts[i - 1];
+  for (int i = 0; i < number_ships; i++)
+    sorted_ships[send_displacements[destinations[i]]++] = ships[i];
+  for (int i = 0; i < size; i++)
+    send_displacements[i] -= send_counts[i];
+  addToCounter(COUNTER_BYTES_SENT, (long long)(number_ships - send_counts[myrank]) * sizeof(struct migrating_ship_struct));
+
+  MPI_Alltoall(send_counts, 1, MPI_INT, receive_counts, 1, MPI_INT, migration_comm);
+  receive_displacements[0] = 0;
+  for (int i = 1; i < size; i++)
+    receive_displacements[i] = receive_displacements[i - 1] + receive_counts[i - 1];
+  receive_buffer.number_ships = receive_displacements[size - 1] + receive_counts[size - 1];
+  reserveMigrationBuffer(&receive_buffer, receive_buffer.number_ships);
+
+  MPI_Alltoallv(sorted_ships, send_counts, send_displacements, migrating_ship_type, receive_buffer.ships, receive_counts,
+                receive_displacements, migrating_ship_type, migration_comm);
+
+  free(send_counts);
+  free(send_displacements);
+  free(receive_counts);
+  free(receive_displacements);
+  free(sorted_ships);
+
+  *arrivals = receive_buffer.ships;
+  return receive_buffer.number_ships;
+}
+
+// Returns the derived data type describing a packed ship, which is valid between initialiseMigration and finaliseMigration
+MPI_Datatype getMigratingShipType()
+{
+  return migrating_ship_type;
+}
+
+// Frees the migration buffers, the exchange of ships (or inbox) and the derived data type. Every process must call this
+// together
+void finaliseMigration()
+{
+  for (int i = 0; i < number_neighbours; i++)
+    free(send_buffers[i].ships);
+  free(send_buffers);
+  free(receive_buffer.ships);
+  free(send_data);
+  free(send_counts);
+  free(neighbour_ranks);
+  if (migration_mode == MIGRATION_TWO_SIDED)
+  {
+    finaliseExchange(&ship_exchange);
+  }
+  else
+  {
+    MPI_Win_free(&inbox_window);
+    MPI_Group_free(&neighbour_group);
+    free(overflow_requests);
+  }
+  MPI_Type_free(&migrating_ship_type);
+}
+
+// Allocates the inbox window of this process for one sided migration, with no ships in it, and the group of the
+// neighbours that exist. Every process must call this together
+static void initialiseInbox(MPI_Comm comm)
+{
+  inbox_header_size = (int)(((sizeof(int) * number_neighbours) + 7) / 8) * 8;
+  MPI_Aint inbox_size = inbox_header_size + (MPI_Aint)number_neighbours * INBOX_REGION_SHIPS * sizeof(struct migrating_ship_struct);
+  MPI_Win_allocate(inbox_size, 1, MPI_INFO_NULL, comm, &inbox, &inbox_window);
+  memset(inbox, 0, inbox_header_size);
+
+  MPI_Group comm_group;
+  int *existing_ranks = (int *)malloc(sizeof(int) * number_neighbours);
+  int number_existing = 0;
+  overflow_requests = (MPI_Request *)malloc(sizeof(MPI_Request) * number_neighbours);
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    overflow_requests[i] = MPI_REQUEST_NULL;
+    if (neighbour_ranks[i] != MPI_PROC_NULL)
+      existing_ranks[number_existing++] = neighbour_ranks[i];
+  }
+  MPI_Comm_group(comm, &comm_group);
+  MPI_Group_incl(comm_group, number_existing, existing_ranks, &neighbour_group);
+  MPI_Group_free(&comm_group);
+  free(existing_ranks);
+}
+
+// Starts a one sided exchange, in a single epoch with the neighbours that each exposes its inbox to the others and puts
+// the queued ships into theirs. The number of ships is put into the header of the inbox for the direction of this
+// process as seen from the neighbour (the opposite of the neighbour's direction, as the neighbours are in the order of
+// NEIGHBOUR_INDEX), and the ships into its region. Ships that do not fit in the region are sent in a message instead,
+// so the inbox never needs to grow. As each process has its own region in an inbox no slots need to be reserved
+static void startOneSidedExchange()
+{
+  int ship_size = sizeof(struct migrating_ship_struct);
+  MPI_Win_post(neighbour_group, 0, inbox_window);
+  MPI_Win_start(neighbour_group, 0, inbox_window);
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    if (neighbour_ranks[i] == MPI_PROC_NULL)
+      continue;
+    int direction = number_neighbours - 1 - i;
+    int number_ships = send_buffers[i].number_ships;
+    int in_inbox = number_ships < INBOX_REGION_SHIPS ? number_ships : INBOX_REGION_SHIPS;
+    MPI_Put(&send_buffers[i].number_ships, 1, MPI_INT, neighbour_ranks[i], direction * sizeof(int), 1, MPI_INT, inbox_window);
+    if (in_inbox > 0)
+      MPI_Put(send_buffers[i].ships, in_inbox * ship_size, MPI_BYTE, neighbour_ranks[i],
+              inbox_header_size + (MPI_Aint)direction * INBOX_REGION_SHIPS * ship_size, in_inbox * ship_size, MPI_BYTE, inbox_window);
+    if (number_ships > in_inbox)
+      MPI_Isend(&send_buffers[i].ships[in_inbox], number_ships - in_inbox, migrating_ship_type, neighbour_ranks[i],
+                INBOX_OVERFLOW_TAG, migration_comm, &overflow_requests[i]);
+  }
+}
+
+// Completes a one sided exchange, once every neighbour has finished putting ships into the inbox of this process they
+// are copied from it into the receive buffer in order of neighbour, followed by any that overflowed the inbox
+static void finishOneSidedExchange()
+{
+  int ship_size = sizeof(struct migrating_ship_struct);
+  MPI_Win_complete(inbox_window);
+  MPI_Win_wait(inbox_window);
+  receive_buffer.number_ships = 0;
+  for (int i = 0; i < number_neighbours; i++)
+  {
+    if (neighbour_ranks[i] == MPI_PROC_NULL)
+      continue;
+    int incoming;
+    memcpy(&incoming, &inbox[i * sizeof(int)], sizeof(int));
+    int in_inbox = incoming < INBOX_REGION_SHIPS ? incoming : INBOX_REGION_SHIPS;
+    reserveMigrationBuffer(&receive_buffer, receive_buffer.number_ships + incoming);
+    memcpy(&receive_buffer.ships[receive_buffer.number_ships], &inbox[inbox_header_size + (size_t)i * INBOX_REGION_SHIPS * ship_size],
+           (size_t)in_inbox * ship_size);
+    if (incoming > in_inbox)
+      MPI_Recv(&receive_buffer.ships[receive_buffer.number_ships + in_inbox], incoming - in_inbox, migrating_ship_type,
+               neighbour_ranks[i], INBOX_OVERFLOW_TAG, migration_comm, MPI_STATUS_IGNORE);
+    receive_buffer.number_ships += incoming;
+  }
+  MPI_Waitall(number_neighbours, overflow_requests, MPI_STATUSES_IGNORE);
+}
+
+// Makes sure a migration buffer can hold the number of ships provided, the existing contents are kept. The buffer
+// grows geometrically so that over a run the number of reallocations is logarithmic in the largest migration
+static void reserveMigrationBuffer(struct migration_buffer_struct *buffer, int number_ships)
+{
+  if (number_ships <= buffer->capacity)
+    return;
+  int new_capacity = buffer->capacity > 0 ? buffer->capacity : 64;
+  while (new_capacity < number_ships)
+    new_capacity *= 2;
+  buffer->ships = (struct migrating_ship_struct *)realloc(buffer->ships, sizeof(struct migrating_ship_struct) * new_capacity);
+  if (buffer->ships == NULL)
+  {
+    fprintf(stderr, "Error, unable to grow a migration buffer to %d ships\n", new_capacity);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+  buffer->capacity = new_capacity;
+}
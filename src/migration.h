@@ -0,0 +1,26 @@
+#ifndef MIGRATION_INCLUDE
+#define MIGRATION_INCLUDE
+
+#include "mpi.h"
+
+// How ships are sent to the neighbouring processes each timestep, selected by MIGRATION_MODE in the configuration
+#define MIGRATION_TWO_SIDED 0 // Messages exchanged through persistent requests
+#define MIGRATION_ONE_SIDED 1 // Put directly into an inbox window of each neighbour
+
+// A ship travelling between processes, packed along with the global X and Y coordinates of the cell that it is moving into
+struct migrating_ship_struct
+{
+  int route, routeStep, hoursAtSea, id, cargoAmount;
+  int x, y;
+};
+
+void initialiseMigration(int, int *, MPI_Comm, int);
+void queueMigratingShip(int, struct migrating_ship_struct *);
+int exchangeMigratingShips(struct migrating_ship_struct **);
+void startMigratingShipExchange();
+int finishMigratingShipExchange(struct migrating_ship_struct **);
+int redistributeShips(struct migrating_ship_struct *, int *, int, struct migrating_ship_struct **);
+MPI_Datatype getMigratingShipType();
+void finaliseMigration();
+
+#endif
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mpi.h"
+#include "performance.h"
+
+// Each row of the performance file is the timestep, followed by the time spent in each phase and then each counter
+#define ROW_WIDTH (1 + NUMBER_TIMERS + NUMBER_COUNTERS)
+
+static char *timer_names[NUMBER_TIMERS] = {"route_planning", "properties", "movement", "migration", "rebalance", "checkpoint", "telemetry", "report"};
+static char *counter_names[NUMBER_COUNTERS] = {"ships_moved", "ships_migrated", "ships_created", "ships_removed", "bytes_sent"};
+
+// The time spent in each phase and the count of each event on this process since the start of the run, along with when
+// each running timer was started and the totals when the last row was recorded
+static double timer_totals[NUMBER_TIMERS], timer_starts[NUMBER_TIMERS];
+static long long counter_totals[NUMBER_COUNTERS];
+static double last_row_totals[NUMBER_TIMERS + NUMBER_COUNTERS];
+// Rows recorded by this process every few timesteps, each ROW_WIDTH values, which are written out at the end of the run
+static double *rows = NULL;
+static int number_rows, rows_capacity, every;
+
+static void printPerformanceSummary(char *, char *, double *, int, int);
+static void writePerformanceRows(char *);
+
+// Sets up the timers and counters of this process, all starting from zero. If record_every is more than zero then their
+// values are also recorded every that many timesteps and written to a file at the end of the run
+void initialisePerformance(int record_every)
+{
+  for (int i = 0; i < NUMBER_TIMERS; i++)
+    timer_totals[i] = 0.0;
+  for (int i = 0; i < NUMBER_COUNTERS; i++)
+    counter_totals[i] = 0;
+  for (int i = 0; i < NUMBER_TIMERS + NUMBER_COUNTERS; i++)
+    last_row_totals[i] = 0.0;
+  every = record_every;
+  number_rows = 0;
+  rows_capacity = 0;
+}
+
+// Starts timing a phase, only the thread that makes the MPI calls should time phases
+void startTimer(int timer)
+{
+  timer_starts[timer] = MPI_Wtime();
+}
+
+// Stops timing a phase, adding the time since it was started to its total
+void stopTimer(int timer)
+{
+  timer_totals[timer] += MPI_Wtime() - timer_starts[timer];
+}
+
+// Adds to the count of an event on this process, this is not thread safe so threads should count into their own variables
+// and add them once they are done
+void addToCounter(int counter, long long amount)
+{
+  counter_totals[counter] += amount;
+}
+
+// Called at the end of each timestep, if the timestep is due to be recorded then a row holding the time spent in each
+// phase and the events counted since the last row was recorded is added
+void completePerformanceStep(int timestep)
+{
+  if (every <= 0 || timestep % every != 0)
+    return;
+  if (number_rows == rows_capacity)
+  {
+    rows_capacity = rows_capacity > 0 ? rows_capacity * 2 : 64;
+    rows = (double *)realloc(rows, sizeof(double) * ROW_WIDTH * rows_capacity);
+  }
+  double *row = &rows[number_rows * ROW_WIDTH];
+  row[0] = timestep;
+  for (int i = 0; i < NUMBER_TIMERS + NUMBER_COUNTERS; i++)
+  {
+    double total = i < NUMBER_TIMERS ? timer_totals[i] : (double)counter_totals[i - NUMBER_TIMERS];
+    row[1 + i] = total - last_row_totals[i];
+    last_row_totals[i] = total;
+  }
+  number_rows++;
+}
+
+// Prints the minimum, mean and maximum over the processes of the total for each phase and event, along with which
+// process had the largest, and writes any rows recorded to the file provided. Every process must call this together
+void reportPerformance(char *filename)
+{
+  int myrank, size;
+  double totals[NUMBER_TIMERS + NUMBER_COUNTERS];
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  for (int i = 0; i < NUMBER_TIMERS; i++)
+    totals[i] = timer_totals[i];
+  for (int i = 0; i < NUMBER_COUNTERS; i++)
+    totals[NUMBER_TIMERS + i] = (double)counter_totals[i];
+
+  double *all_totals = NULL;
+  if (myrank == 0)
+    all_totals = (double *)malloc(sizeof(double) * (NUMBER_TIMERS + NUMBER_COUNTERS) * size);
+  MPI_Gather(totals, NUMBER_TIMERS + NUMBER_COUNTERS, MPI_DOUBLE, all_totals, NUMBER_TIMERS + NUMBER_COUNTERS, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  if (myrank == 0)
+  {
+    printf("======= Performance over %d processes =======\n", size);
+    printf("%-16s %12s %12s %12s %10s %8s\n", "Phase (s)", "min", "mean", "max", "max/mean", "slowest");
+    for (int i = 0; i < NUMBER_TIMERS; i++)
+      printPerformanceSummary(timer_names[i], "%-16s %12.4f %12.4f %12.4f %10.2f %8d\n", all_totals, i, size);
+    printf("%-16s %12s %12s %12s %10s %8s\n", "Counter", "min", "mean", "max", "max/mean", "busiest");
+    for (int i = 0; i < NUMBER_COUNTERS; i++)
+      printPerformanceSummary(counter_names[i], "%-16s %12.0f %12.1f %12.0f %10.2f %8d\n", all_totals, NUMBER_TIMERS + i, size);
+    free(all_totals);
+  }
+
+  if (every > 0)
+    writePerformanceRows(filename);
+  free(rows);
+  rows = NULL;
+}
+
+// Prints one line of the performance summary, for the value at index of the totals of every process
+static void printPerformanceSummary(char *name, char *format, double *all_totals, int index, int size)
+{
+  double min = all_totals[index], max = all_totals[index], sum = 0.0;
+  int largest = 0;
+  for (int process = 0; process < size; process++)
+  {
+    double value = all_totals[process * (NUMBER_TIMERS + NUMBER_COUNTERS) + index];
+    sum += value;
+    if (value < min)
+      min = value;
+    if (value > max)
+    {
+      max = value;
+      largest = process;
+    }
+  }
+  double mean = sum / size;
+  printf(format, name, min, mean, max, mean > 0.0 ? max / mean : 1.0, largest);
+}
+
+// Writes the rows recorded by every process to a CSV file, process 0 writes its own rows and then receives and writes
+// those of each other process in turn, so only one process's rows are held at once. Every process must call this together
+static void writePerformanceRows(char *filename)
+{
+  int myrank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if (myrank != 0)
+  {
+    MPI_Send(rows, number_rows * ROW_WIDTH, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+    return;
+  }
+
+  FILE *f = fopen(filename, "w");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Error, unable to open the performance file '%s'\n", filename);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
+  fprintf(f, "timestep,process");
+  for (int i = 0; i < NUMBER_TIMERS; i++)
+    fprintf(f, ",%s", timer_names[i]);
+  for (int i = 0; i < NUMBER_COUNTERS; i++)
+    fprintf(f, ",%s", counter_names[i]);
+  fprintf(f, "\n");
+  // Every process records the same timesteps, so the rows of the others fit in this process's buffer
+  for (int process = 0; process < size; process++)
+  {
+    if (process > 0)
+      MPI_Recv(rows, number_rows * ROW_WIDTH, MPI_DOUBLE, process, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    for (int r = 0; r < number_rows; r++)
+    {
+      double *row = &rows[r * ROW_WIDTH];
+      fprintf(f, "%d,%d", (int)row[0], process);
+      for (int i = 0; i < NUMBER_TIMERS; i++)
+        fprintf(f, ",%.6f", row[1 + i]);
+      for (int i = 0; i < NUMBER_COUNTERS; i++)
+        fprintf(f, ",%.0f", row[1 + NUMBER_TIMERS + i]);
+      fprintf(f, "\n");
+    }
+  }
+  fclose(f);
+  printf("Wrote the performance of each process every %d timesteps to %s\n", every, filename);
+}
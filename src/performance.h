@@ -0,0 +1,30 @@
+#ifndef PERFORMANCE_INCLUDE
+#define PERFORMANCE_INCLUDE
+
+// The phases of the run that are timed on each process
+#define TIMER_ROUTE_PLANNING 0 // Planning the routes, once before the simulation
+#define TIMER_PROPERTIES 1     // Updating the properties of the water cells and ports
+#define TIMER_MOVEMENT 2       // Moving ships within the sub_domain
+#define TIMER_MIGRATION 3      // Exchanging ships with the neighbouring processes and placing the arrivals
+#define TIMER_REBALANCE 4      // Rebalancing the sub_domains
+#define TIMER_CHECKPOINT 5     // Writing checkpoints
+#define TIMER_TELEMETRY 6      // Recording telemetry
+#define TIMER_REPORT 7         // Measuring and reporting the statistics
+#define NUMBER_TIMERS 8
+
+// The events that are counted on each process
+#define COUNTER_SHIPS_MOVED 0    // Ships moved into another cell
+#define COUNTER_SHIPS_MIGRATED 1 // Ships sent to another process as they moved
+#define COUNTER_SHIPS_CREATED 2  // Ships created by ports
+#define COUNTER_SHIPS_REMOVED 3  // Ships removed by ports
+#define COUNTER_BYTES_SENT 4     // Bytes of ships sent to other processes, by migration and redistribution
+#define NUMBER_COUNTERS 5
+
+void initialisePerformance(int);
+void startTimer(int);
+void stopTimer(int);
+void addToCounter(int, long long);
+void completePerformanceStep(int);
+void reportPerformance(char *);
+
+#endif
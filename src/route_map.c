@@ -2,181 +2,241 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "route_map.h"
+#include "cell_layout.h"
 #include "mpi.h"
 
-#define ROUTES_MAX 100
 #define BLOCKED_CELL -20
 #define LOW_SCORE -10
-
-// Data structure to hold each route, the start and target ports along with the route itself
+// What occupies each cell of the domain, as far as the shortest route planner is concerned
+#define CELL_WATER 0
+#define CELL_ISLAND 1
+#define CELL_PORT 2
+
+// Data structure to hold each route, the start and target ports along with the route itself. The route is held as the
+// global X and Y coordinates of each cell visited after the starting port in order, so a ship that has taken step moves
+// (zero being at the starting port) moves next into the cell at cells[step * 2], cells[step * 2 + 1]
 struct specific_route
 {
   int start_x, start_y, target_x, target_y;
-  int *route;
+  int number_cells;
+  int *cells;
 };
 
-int size_x, size_y, current_route_index, num_blocked_cells;
+int size_x, size_y, current_route_index;
+
+// Decomposition of this process, held privately as a copy of what the main program has decided
+static int local_nx, local_ny, basex, basey, mem_size_x, mem_size_y;
 
-int local_nx, size, myrank, basex, mem_size_x, mem_size_y;
+// Configuration of the simulation, for looking up which cells are blocked (e.g. islands)
+static struct simulation_configuration_struct configuration;
+struct specific_route *routes; // All routes that we have planned
+static int *route_cells;       // Cells of all routes one after another, each route points into this
 
-int *blocked_cells_x;                     // X coordinates of blocked sea cells (e.g. islands)
-int *blocked_cells_y;                     // Y coordinates of blocked sea cells (e.g. islands)
-struct specific_route routes[ROUTES_MAX]; // All routes that we have planned
+// Cells visited by the routes planned by this process, stored as X and Y pairs one route after another
+static int *planned_cells;
+static int number_planned_cells, planned_cells_capacity;
+
+// Scratch space of the shortest route planner over the whole domain, laid out as CELL_INDEX gives. cell_types holds what
+// occupies each cell, and distances the number of moves from the source cell to each cell (-1 where it can not be
+// reached). The distances are kept between routes, as consecutive routes planned by a process normally share their
+// starting port, which is held in distance_source as x * size_y + y. The search queue holds cells in the same way
+static unsigned char *cell_types = NULL;
+static int *distances = NULL, *search_queue = NULL;
+static long long distance_source = -1;
 
 static int generate_score(int, int, int, int, int, int);
-static void display_specific_route(struct specific_route *);
 static bool is_cell_blocked(int, int);
-void perform_halo_swap(int myrank, int size, int local_nx, int ny, int mem_size_y, int *data);
-
-// You can uncomment this main function and compile independently to get a feeling for how the route planning works.
-// This will set up a size of 16 by 16 grid with two blocked cells, and plan a route working around these blockages.
-// Note this is just a testing/illustration main function driver and you will need to leave this commented out (or delete)
-// to compile the code as part of the entire simulation
-/*
-int main() {
-  size_x=16;
-  size_y=16;
-  current_route_index=0;
-  num_blocked_cells=2;
-
-
-  blocked_cells_x=(int*) malloc(sizeof(int) * 2);
-  blocked_cells_y=(int*) malloc(sizeof(int) * 2);  
-  blocked_cells_x[0]=2;
-  blocked_cells_y[0]=12;
-
-  blocked_cells_x[1]=5;
-  blocked_cells_y[1]=15;
-
-  int route=generate_route(0, 10, 14, 15);
-  display_specific_route(&routes[route]);
-}
-*/
+static void add_planned_cell(int, int);
+static void calculate_distances(int, int);
+static void free_shortest_route_planner();
 
 // Called from the main program to initialse the routemaps based on the configuration of the simulation
 // that has been loaded in elsewhere
-void initialise_routemap(struct simulation_configuration_struct *simulation_configuration, int local_nx, int myrank, int size, int basex)
+void initialise_routemap(struct simulation_configuration_struct *simulation_configuration, struct decomposition_struct *decomposition)
 {
   size_x = simulation_configuration->size_x;
   size_y = simulation_configuration->size_y;
+  update_routemap_extent(decomposition);
+
+  // The lookups of the configuration are shared rather than copied, so this is cheap
+  configuration = *simulation_configuration;
+  current_route_index = 0;
+  routes = NULL;
+  route_cells = NULL;
+}
 
-  local_nx = local_nx;
-  myrank = myrank;
-  size = size;
-  basex = basex;
+// Sets the extent of the sub_domain owned by this process, called when the routemap is initialised and whenever the
+// decomposition changes. The routes are held for the whole domain so do not need to be planned again
+void update_routemap_extent(struct decomposition_struct *decomposition)
+{
+  local_nx = decomposition->local_nx;
+  local_ny = decomposition->local_ny;
+  basex = decomposition->basex;
+  basey = decomposition->basey;
+  mem_size_x = local_nx + 2;
+  mem_size_y = local_ny + 2;
+}
 
+// Frees the planned routes
+void finalise_routemap()
+{
+  free(routes);
+  free(route_cells);
   current_route_index = 0;
-  num_blocked_cells = simulation_configuration->number_islands;
-  blocked_cells_x = (int *)malloc(sizeof(int) * num_blocked_cells);
-  blocked_cells_y = (int *)malloc(sizeof(int) * num_blocked_cells);
-  for (int i = 0; i < simulation_configuration->number_islands; i++)
-  {
-    blocked_cells_x[i] = simulation_configuration->islands[i].x;
-    blocked_cells_y[i] = simulation_configuration->islands[i].y;
-  }
 }
 
 // Calculates the routes that have been specified in the configuration. These planned routes are then stored here and can be
 // used during the simulation. Note that if it is not possible to plan a route (there are some limitation to the planning logic)
-// then an error is displayed
+// then an error is displayed. Each route is only planned once, the pairs of ports are split into contiguous blocks over the
+// processes which each plan their block as lists of cells. These are then gathered in a single collective, so that every
+// process holds every route in the order of the pairs of ports
 void calculate_routes(struct simulation_configuration_struct *simulation_configuration, int (*generate_route_strategy)(int, int, int, int))
 {
-  for (int i = 0; i < simulation_configuration->number_ports; i++)
+  int size, myrank;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+  int number_ports = simulation_configuration->number_ports;
+  int number_pairs = number_ports * (number_ports - 1);
+  int first_pair = (int)(((long long)number_pairs * myrank) / size);
+  int last_pair = (int)(((long long)number_pairs * (myrank + 1)) / size);
+
+  // The number of cells in each route, -1 if it could not be planned. Each process fills in its own block and leaves zeros
+  // elsewhere, so summing over the processes gives the length of every route
+  int *route_lengths = (int *)calloc(number_pairs > 0 ? number_pairs : 1, sizeof(int));
+  number_planned_cells = 0;
+  for (int pair = first_pair; pair < last_pair; pair++)
   {
-    for (int j = 0; j < simulation_configuration->number_ports; j++)
-    {
-      if (i != j)
-      {
-        int route_index = generate_route_strategy(simulation_configuration->ports[i].x, simulation_configuration->ports[i].y,
+    int i = pair / (number_ports - 1);
+    int j = pair % (number_ports - 1);
+    if (j >= i)
+      j++;
+    route_lengths[pair] = generate_route_strategy(simulation_configuration->ports[i].x, simulation_configuration->ports[i].y,
                                                   simulation_configuration->ports[j].x, simulation_configuration->ports[j].y);
+    if (route_lengths[pair] == -1)
+    {
+      fprintf(stderr, "Error, can not plan a route between points X=%d,Y=%d and X=%d,Y=%d\n",
+              simulation_configuration->ports[i].x, simulation_configuration->ports[i].y,
+              simulation_configuration->ports[j].x, simulation_configuration->ports[j].y);
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, route_lengths, number_pairs, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  free_shortest_route_planner();
 
-        if (route_index == -1)
-        {
-          fprintf(stderr, "Error, can not plan a route between points X=%d,Y=%d and X=%d,Y=%d\n",
-                  simulation_configuration->ports[i].x, simulation_configuration->ports[i].y,
-                  simulation_configuration->ports[j].x, simulation_configuration->ports[j].y);
-        }
-        else
-        {
-          // Swap the boundary values between processes in order for the convenience of getNextCell
-          perform_halo_swap(myrank, size, local_nx, size_y, mem_size_y, routes[route_index].route);
+  // Ships are sent between every pair of ports, so the simulation can not run if any route is missing
+  int missing_routes = 0;
+  for (int pair = 0; pair < number_pairs; pair++)
+  {
+    if (route_lengths[pair] == -1)
+      missing_routes++;
+  }
+  if (missing_routes > 0)
+  {
+    if (myrank == 0)
+      fprintf(stderr, "Error, %d routes between ports could not be planned\n", missing_routes);
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  }
 
-          simulation_configuration->ports[i].target_route_indexes[j] = route_index;
-          // By commenting out the following two lines you can see the routes planned
-          //display_specific_route(&routes[route_index]);
-        }
-      }
+  // As the blocks of pairs are in order of rank, gathering the cells of each process back to back puts every route in order
+  int *receive_counts = (int *)calloc(size, sizeof(int));
+  int *receive_displacements = (int *)malloc(sizeof(int) * size);
+  for (int rank = 0, pair = 0; rank < size; rank++)
+  {
+    int rank_last_pair = (int)(((long long)number_pairs * (rank + 1)) / size);
+    for (; pair < rank_last_pair; pair++)
+    {
+      if (route_lengths[pair] > 0)
+        receive_counts[rank] += route_lengths[pair] * 2;
     }
   }
+  receive_displacements[0] = 0;
+  for (int rank = 1; rank < size; rank++)
+    receive_displacements[rank] = receive_displacements[rank - 1] + receive_counts[rank - 1];
+  int total_cells = receive_displacements[size - 1] + receive_counts[size - 1];
+  route_cells = (int *)malloc(sizeof(int) * (total_cells > 0 ? total_cells : 1));
+  MPI_Allgatherv(planned_cells, number_planned_cells * 2, MPI_INT, route_cells, receive_counts, receive_displacements,
+                 MPI_INT, MPI_COMM_WORLD);
+
+  routes = (struct specific_route *)malloc(sizeof(struct specific_route) * (number_pairs > 0 ? number_pairs : 1));
+  int *next_route_cells = route_cells;
+  for (int pair = 0; pair < number_pairs; pair++)
+  {
+    int i = pair / (number_ports - 1);
+    int j = pair % (number_ports - 1);
+    if (j >= i)
+      j++;
+    if (route_lengths[pair] != -1)
+    {
+      routes[current_route_index].start_x = simulation_configuration->ports[i].x;
+      routes[current_route_index].start_y = simulation_configuration->ports[i].y;
+      routes[current_route_index].target_x = simulation_configuration->ports[j].x;
+      routes[current_route_index].target_y = simulation_configuration->ports[j].y;
+      routes[current_route_index].number_cells = route_lengths[pair];
+      routes[current_route_index].cells = next_route_cells;
+      next_route_cells += route_lengths[pair] * 2;
+
+      simulation_configuration->ports[i].target_route_indexes[j] = current_route_index;
+      current_route_index++;
+    }
+  }
+
+  free(route_lengths);
+  free(receive_counts);
+  free(receive_displacements);
+  free(planned_cells);
+  planned_cells = NULL;
+  planned_cells_capacity = 0;
 }
 
-// Given the route index, and current X and Y location of a ship this will determine the next X and Y locations
-// that the ship should move to in the domain. This part is optimized. In the serial version, it traverses all the
-// coordinates. In this version, we only need to care about the eight grids around the current grid and return the
-// direction
-void getNextCell(int routeIndex, int currentX, int currentY, int *nextX, int *nextY)
+// Returns whether every route between the ports of the configuration can be planned by the strategy given, stopping at
+// the first that can not. The routes are not kept, and no MPI calls are made, so tools can check a configuration the way
+// the simulation will plan it. This must not be called whilst the routemap of a simulation is in use
+bool can_plan_all_routes(struct simulation_configuration_struct *simulation_configuration, int (*generate_route_strategy)(int, int, int, int))
 {
-  int currentRouteCounter = routes[routeIndex].route[(currentX - basex + 1) * mem_size_y + currentY + 1];
-
-  for (int i = -1; i <= 1; i++)
+  size_x = simulation_configuration->size_x;
+  size_y = simulation_configuration->size_y;
+  configuration = *simulation_configuration;
+  bool all_planned = true;
+  for (int i = 0; i < simulation_configuration->number_ports && all_planned; i++)
   {
-    for (int j = -1; j <= 1; j++)
+    for (int j = 0; j < simulation_configuration->number_ports && all_planned; j++)
     {
-      if (currentX + i >= 0 && currentX + i < size_x && currentY + j >= 0 && currentY + j < size_y && routes[routeIndex].route[((currentX - basex + 1 + i) * mem_size_y) + currentY + 1 + j] == currentRouteCounter + 1)
-      {
-        *nextX = i;
-        *nextY = j;
-
-        return;
-      }
+      if (j == i)
+        continue;
+      number_planned_cells = 0;
+      all_planned = generate_route_strategy(simulation_configuration->ports[i].x, simulation_configuration->ports[i].y,
+                                            simulation_configuration->ports[j].x, simulation_configuration->ports[j].y) != -1;
     }
   }
+  free_shortest_route_planner();
+  free(planned_cells);
+  planned_cells = NULL;
+  number_planned_cells = 0;
+  planned_cells_capacity = 0;
+  return all_planned;
+}
+
+// Given the route index, the number of steps a ship has already taken along it, and current X and Y location of a ship
+// this will determine the direction that the ship should move in next (each of X and Y being -1, 0 or 1). As the route
+// is held as a list of cells this is just a lookup of the next cell along it
+void getNextCell(int routeIndex, int step, int currentX, int currentY, int *nextX, int *nextY)
+{
+  int *next_cell = &routes[routeIndex].cells[step * 2];
+  *nextX = next_cell[0] - currentX;
+  *nextY = next_cell[1] - currentY;
 }
 
 // Given the starting X and Y coordinate of a port, and the target port's X and Y coordinate, this function will plan a route from the
-// starting port to the target one. The unique index of the planned route is returned, and the route will work around any blockages in
-// the sea such as islands. This uses a simple scoring approach to determine the unidirectional route (so ships will progress by
-// following the next number along on the grid)
+// starting port to the target one. The cells visited (after the starting port) are added to the planned cells in order and the number of
+// them is returned, or -1 if no route could be found. The route will work around any blockages in the sea such as islands. This uses a
+// simple scoring approach to determine the unidirectional route (so ships will progress by following the next number along on the grid)
 int generate_route(int cell_source_x, int cell_source_y, int cell_target_x, int cell_target_y)
 {
-  routes[current_route_index].start_x = cell_source_x;
-  routes[current_route_index].start_y = cell_source_y;
-  routes[current_route_index].target_x = cell_target_x;
-  routes[current_route_index].target_y = cell_target_y;
-
-  mem_size_x = local_nx + 2;
-  mem_size_y = size_y + 2;
-
-  // Decompose the route
-  routes[current_route_index].route = (int *)malloc(sizeof(int) * mem_size_x * mem_size_y);
-
-  for (int i = 1; i <= local_nx; i++)
-  {
-    for (int j = 1; j <= size_y; j++)
-    {
-      if (is_cell_blocked(basex + i - 1, j - 1))
-      {
-        // If the cell is blocked then it is assigned the value -1
-        routes[current_route_index].route[(i * mem_size_y) + j] = -1;
-      }
-      else
-      {
-        // If the cell is eligable then assign it to be zero score, this will be updated
-        // if the cell is part of the route between the source and target
-        routes[current_route_index].route[(i * mem_size_y) + j] = 0;
-      }
-    }
-  }
   int grid_scores[3][3];
-
-  if (cell_source_x - basex < local_nx && cell_source_x - basex >= 0)
-  {
-    routes[current_route_index].route[((cell_source_x - basex + 1) * mem_size_y) + cell_source_y + 1] = 0; // Starting port is assigned zero score
-  }
+  int first_planned_cell = number_planned_cells;
   int current_x = cell_source_x;
   int current_y = cell_source_y;
   bool found_route = false;
-  int routeCounter = 1;
 
   // This works by starting at the start port and exploring all possible movements in X and Y (9 possible movements). Each of these is scored
   // according to whether it is closer to the target port or not (or blocked etc) with the highest score being if an advance is made in both
@@ -217,54 +277,159 @@ int generate_route(int cell_source_x, int cell_source_y, int cell_target_x, int
     // If the current X and current Y are the target port then we have arrived and job done!
     if (current_x == cell_target_x && current_y == cell_target_y)
       found_route = true;
-    if (current_x - basex < local_nx && current_x - basex >= 0)
-    {
-      routes[current_route_index].route[((current_x - basex + 1) * mem_size_y) + current_y + 1] = routeCounter;
-    }
-    routeCounter++;
+    add_planned_cell(current_x, current_y);
   }
 
   if (found_route)
   {
-    current_route_index++;
-    return current_route_index - 1;
+    return number_planned_cells - first_planned_cell;
   }
   else
   {
+    number_planned_cells = first_planned_cell;
     return -1;
   }
 }
 
-// Performs the halo swap of the boundary grids of route
-void perform_halo_swap(int myrank, int size, int local_nx, int ny, int mem_size_y, int *data)
+// Plans the shortest route from the starting X and Y coordinate of a port to the target port's X and Y coordinate, as
+// generate_route does, where ships move one cell in any of the eight directions each timestep. A breadth first search from
+// the starting port gives the fewest moves to every cell, and the route is found by walking back from the target to the
+// starting port through cells that are one move closer each time. The search is shared by every route from the same
+// starting port, so a process planning the routes from a port to all of the others searches once. Routes only pass
+// through water, other ports are not passed through as ships arriving in them would dock
+int generate_shortest_route(int cell_source_x, int cell_source_y, int cell_target_x, int cell_target_y)
 {
-  MPI_Request requests[] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+  if ((long long)cell_source_x * size_y + cell_source_y != distance_source)
+    calculate_distances(cell_source_x, cell_source_y);
+  int number_cells = distances[CELL_INDEX(cell_target_x, cell_target_y, size_y)];
+  if (number_cells <= 0)
+    return -1;
 
-  if (myrank > 0)
+  // The route is filled in from the target backwards, so space for all of its cells is added first
+  int first_planned_cell = number_planned_cells;
+  for (int i = 0; i < number_cells; i++)
+    add_planned_cell(0, 0);
+  int current_x = cell_target_x, current_y = cell_target_y;
+  for (int i = number_cells - 1; i >= 0; i--)
   {
-    MPI_Isend(&data[1 + mem_size_y], ny, MPI_INT, myrank - 1, 0, MPI_COMM_WORLD, &requests[0]);
+    planned_cells[(first_planned_cell + i) * 2] = current_x;
+    planned_cells[((first_planned_cell + i) * 2) + 1] = current_y;
+    bool found_previous = false;
+    for (int offset_x = -1; offset_x <= 1 && !found_previous; offset_x++)
+    {
+      for (int offset_y = -1; offset_y <= 1 && !found_previous; offset_y++)
+      {
+        int x = current_x + offset_x, y = current_y + offset_y;
+        if (x < 0 || x >= size_x || y < 0 || y >= size_y)
+          continue;
+        long long cell = CELL_INDEX(x, y, size_y);
+        // Other ports at the right distance were never searched onwards from, so the route can not have come from them
+        if (distances[cell] == i && (cell_types[cell] != CELL_PORT || (long long)x * size_y + y == distance_source))
+        {
+          current_x = x;
+          current_y = y;
+          found_previous = true;
+        }
+      }
+    }
+  }
+  return number_cells;
+}
 
-    MPI_Irecv(&data[1], ny, MPI_INT, myrank - 1, 0, MPI_COMM_WORLD, &requests[1]);
+// Adds a cell to the end of the list of cells visited by the routes planned by this process, growing it if needed
+static void add_planned_cell(int x, int y)
+{
+  if (number_planned_cells == planned_cells_capacity)
+  {
+    planned_cells_capacity = planned_cells_capacity > 0 ? planned_cells_capacity * 2 : 1024;
+    planned_cells = (int *)realloc(planned_cells, sizeof(int) * planned_cells_capacity * 2);
+    if (planned_cells == NULL)
+    {
+      fprintf(stderr, "Error, unable to grow the planned route cells to %d\n", planned_cells_capacity);
+      exit(-1);
+    }
   }
-  if (myrank < size - 1)
+  planned_cells[number_planned_cells * 2] = x;
+  planned_cells[(number_planned_cells * 2) + 1] = y;
+  number_planned_cells++;
+}
+
+// Calculates the fewest moves from a source cell to every cell of the domain by a breadth first search into distances.
+// Islands are never entered and ports are reached but not passed through. The types of the cells are looked up once, the
+// first time that this is called
+static void calculate_distances(int source_x, int source_y)
+{
+  long long number_cells = CELL_GRID_SIZE(size_x, size_y);
+  if (cell_types == NULL)
   {
-    MPI_Isend(&data[(local_nx * mem_size_y) + 1], ny, MPI_INT, myrank + 1, 0, MPI_COMM_WORLD, &requests[2]);
+    cell_types = (unsigned char *)malloc(number_cells);
+    distances = (int *)malloc(sizeof(int) * number_cells);
+    search_queue = (int *)malloc(sizeof(int) * (long long)size_x * size_y);
+    if (cell_types == NULL || distances == NULL || search_queue == NULL)
+    {
+      fprintf(stderr, "Error, unable to allocate the route planner for %lld cells\n", number_cells);
+      exit(-1);
+    }
+    for (int x = 0; x < size_x; x++)
+    {
+      for (int y = 0; y < size_y; y++)
+        cell_types[CELL_INDEX(x, y, size_y)] = is_cell_blocked(x, y) ? CELL_ISLAND : CELL_WATER;
+    }
+    for (int i = 0; i < configuration.number_ports; i++)
+    {
+      if (configuration.ports[i].x >= 0 && configuration.ports[i].x < size_x && configuration.ports[i].y >= 0 && configuration.ports[i].y < size_y)
+        cell_types[CELL_INDEX(configuration.ports[i].x, configuration.ports[i].y, size_y)] = CELL_PORT;
+    }
+  }
 
-    MPI_Irecv(&data[((local_nx + 1) * mem_size_y) + 1], ny, MPI_INT, myrank + 1, 0, MPI_COMM_WORLD, &requests[3]);
+  for (long long cell = 0; cell < number_cells; cell++)
+    distances[cell] = -1;
+  distance_source = (long long)source_x * size_y + source_y;
+  distances[CELL_INDEX(source_x, source_y, size_y)] = 0;
+  long long head = 0, tail = 0;
+  search_queue[tail++] = (int)distance_source;
+  while (head < tail)
+  {
+    int position = search_queue[head++];
+    int x = position / size_y, y = position % size_y;
+    long long cell = CELL_INDEX(x, y, size_y);
+    // Other ports are the end of a route, so the search carries on only from water and the source port
+    if (cell_types[cell] == CELL_PORT && position != distance_source)
+      continue;
+    for (int offset_x = -1; offset_x <= 1; offset_x++)
+    {
+      for (int offset_y = -1; offset_y <= 1; offset_y++)
+      {
+        int neighbour_x = x + offset_x, neighbour_y = y + offset_y;
+        if (neighbour_x < 0 || neighbour_x >= size_x || neighbour_y < 0 || neighbour_y >= size_y)
+          continue;
+        long long neighbour = CELL_INDEX(neighbour_x, neighbour_y, size_y);
+        if (distances[neighbour] == -1 && cell_types[neighbour] != CELL_ISLAND)
+        {
+          distances[neighbour] = distances[cell] + 1;
+          search_queue[tail++] = neighbour_x * size_y + neighbour_y;
+        }
+      }
+    }
   }
+}
 
-  MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+// Frees the scratch space of the shortest route planner, once every route has been planned
+static void free_shortest_route_planner()
+{
+  free(cell_types);
+  free(distances);
+  free(search_queue);
+  cell_types = NULL;
+  distances = NULL;
+  search_queue = NULL;
+  distance_source = -1;
 }
 
 // Given an x and y coordinate this will determine whether that cell is blocked or not
 static bool is_cell_blocked(int x, int y)
 {
-  for (int i = 0; i < num_blocked_cells; i++)
-  {
-    if (blocked_cells_x[i] == x && blocked_cells_y[i] == y)
-      return true;
-  }
-  return false;
+  return isCellAnIsland(&configuration, x, y);
 }
 
 // Given the starting X and Y coordinate, the target X and Y coordinate and the offset movement in the X and Y dimension this function will
@@ -285,26 +450,3 @@ static int generate_score(int cell_source_x, int cell_source_y, int cell_target_
   int y_diff = abs(cell_target_y - cell_source_y) - abs(cell_target_y - (cell_source_y + offset_y));
   return x_diff + y_diff;
 }
-
-// Helper function to display a specific route on stdio, helps with debugging
-static void display_specific_route(struct specific_route *route_to_display)
-{
-  for (int i = 0; i < size_x; i++)
-  {
-    char displayLine[100];
-    displayLine[0] = '\0';
-    for (int j = 0; j < size_y; j++)
-    {
-      int val = route_to_display->route[(i * size_y) + j];
-      if (val >= 0)
-      {
-        sprintf(displayLine, "%s %d", displayLine, val);
-      }
-      else
-      {
-        sprintf(displayLine, "%s X", displayLine);
-      }
-    }
-    printf("%s\n", displayLine);
-  }
-}
@@ -2,10 +2,23 @@
 #define ROUTEMAP_INCLUDE
 
 #include "simulation_configuration.h"
+#include "decomposition.h"
 
-void initialise_routemap(struct simulation_configuration_struct *, int, int, int, int);
+// Which planner the routes between ports are planned by, can be overridden when compiling, e.g.
+// make CPPFLAGS="-DROUTE_PLANNER_TO_USE=1" for the shortest routes
+// 0 = greedy, each move is the one that makes the most progress towards the target, without ever backtracking
+// 1 = shortest, a breadth first search from each port through water (not through other ports)
+#ifndef ROUTE_PLANNER_TO_USE
+#define ROUTE_PLANNER_TO_USE 0
+#endif
+
+void initialise_routemap(struct simulation_configuration_struct *, struct decomposition_struct *);
+void update_routemap_extent(struct decomposition_struct *);
+void finalise_routemap();
 void calculate_routes(struct simulation_configuration_struct *, int (*)(int, int, int, int));
 int generate_route(int, int, int, int);
-void getNextCell(int, int, int, int *, int *);
+int generate_shortest_route(int, int, int, int);
+bool can_plan_all_routes(struct simulation_configuration_struct *, int (*)(int, int, int, int));
+void getNextCell(int, int, int, int, int *, int *);
 
 #endif
\ No newline at end of file
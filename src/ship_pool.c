@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ship_pool.h"
+
+// The ships owned by this process
+struct ship_pool_struct ship_pool;
+
+static void growShipPool();
+
+// Sets up an empty ship pool with space for the initial number of ships provided, the pool will grow as required
+void initialiseShipPool(int initial_capacity)
+{
+  ship_pool.capacity = initial_capacity > 0 ? initial_capacity : 1;
+  ship_pool.high_water_mark = 0;
+  ship_pool.number_ships = 0;
+  ship_pool.first_free = -1;
+  ship_pool.route = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.routeStep = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.hoursAtSea = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.id = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.cargoAmount = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.willMoveThisTimestep = (bool *)malloc(sizeof(bool) * ship_pool.capacity);
+  ship_pool.cell = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.next_ship = (int *)malloc(sizeof(int) * ship_pool.capacity);
+  ship_pool.previous_ship = (int *)malloc(sizeof(int) * ship_pool.capacity);
+}
+
+// Hands out a slot for a new ship with all properties set to zero, the ship is not yet placed in any cell. Released
+// slots are reused first so the pool only grows when the number of live ships does
+int allocateShip()
+{
+  int ship;
+  if (ship_pool.first_free != -1)
+  {
+    ship = ship_pool.first_free;
+    ship_pool.first_free = ship_pool.next_ship[ship];
+  }
+  else
+  {
+    if (ship_pool.high_water_mark == ship_pool.capacity)
+      growShipPool();
+    ship = ship_pool.high_water_mark++;
+  }
+  ship_pool.route[ship] = 0;
+  ship_pool.routeStep[ship] = 0;
+  ship_pool.hoursAtSea[ship] = 0;
+  ship_pool.id[ship] = 0;
+  ship_pool.cargoAmount[ship] = 0;
+  ship_pool.willMoveThisTimestep[ship] = false;
+  ship_pool.cell[ship] = -1;
+  ship_pool.next_ship[ship] = -1;
+  ship_pool.previous_ship[ship] = -1;
+  ship_pool.number_ships++;
+  return ship;
+}
+
+// Returns the slot of a ship that has left this process (or been removed from the simulation) to the free list so that
+// it can be handed out again. The ship must already have been unlinked from its cell
+void releaseShip(int ship)
+{
+  ship_pool.cell[ship] = -1;
+  ship_pool.next_ship[ship] = ship_pool.first_free;
+  ship_pool.first_free = ship;
+  ship_pool.number_ships--;
+}
+
+// Frees the memory held by the ship pool
+void finaliseShipPool()
+{
+  free(ship_pool.route);
+  free(ship_pool.routeStep);
+  free(ship_pool.hoursAtSea);
+  free(ship_pool.id);
+  free(ship_pool.cargoAmount);
+  free(ship_pool.willMoveThisTimestep);
+  free(ship_pool.cell);
+  free(ship_pool.next_ship);
+  free(ship_pool.previous_ship);
+}
+
+// Doubles the number of slots in the pool, as ships are referred to by slot index rather than pointer this is safe
+// to do at any point
+static void growShipPool()
+{
+  ship_pool.capacity *= 2;
+  ship_pool.route = (int *)realloc(ship_pool.route, sizeof(int) * ship_pool.capacity);
+  ship_pool.routeStep = (int *)realloc(ship_pool.routeStep, sizeof(int) * ship_pool.capacity);
+  ship_pool.hoursAtSea = (int *)realloc(ship_pool.hoursAtSea, sizeof(int) * ship_pool.capacity);
+  ship_pool.id = (int *)realloc(ship_pool.id, sizeof(int) * ship_pool.capacity);
+  ship_pool.cargoAmount = (int *)realloc(ship_pool.cargoAmount, sizeof(int) * ship_pool.capacity);
+  ship_pool.willMoveThisTimestep = (bool *)realloc(ship_pool.willMoveThisTimestep, sizeof(bool) * ship_pool.capacity);
+  ship_pool.cell = (int *)realloc(ship_pool.cell, sizeof(int) * ship_pool.capacity);
+  ship_pool.next_ship = (int *)realloc(ship_pool.next_ship, sizeof(int) * ship_pool.capacity);
+  ship_pool.previous_ship = (int *)realloc(ship_pool.previous_ship, sizeof(int) * ship_pool.capacity);
+  if (ship_pool.route == NULL || ship_pool.routeStep == NULL || ship_pool.hoursAtSea == NULL || ship_pool.id == NULL || ship_pool.cargoAmount == NULL ||
+      ship_pool.willMoveThisTimestep == NULL || ship_pool.cell == NULL || ship_pool.next_ship == NULL || ship_pool.previous_ship == NULL)
+  {
+    fprintf(stderr, "Error, unable to grow the ship pool to %d ships\n", ship_pool.capacity);
+    exit(-1);
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef SHIPPOOL_INCLUDE
+#define SHIPPOOL_INCLUDE
+
+#include <stdbool.h>
+
+// Structure of arrays holding every ship owned by this process. A ship is identified by its slot index in
+// the pool, and each array is indexed by that slot
+// route, hoursAtSea, id, cargoAmount, willMoveThisTimestep = the properties of the ship
+// routeStep = number of steps the ship has taken along its route, zero when it leaves a port
+// cell = index of the sub_domain cell the ship resides in, or -1 if the slot is not in use
+// next_ship, previous_ship = links chaining together the ships that reside in the same cell (-1 terminates), for a
+// slot that is not in use next_ship instead chains it onto the free list
+// capacity = number of slots allocated, high_water_mark = number of slots ever handed out, number_ships = live ships
+// first_free = most recently released slot that can be handed out again (-1 if there are none)
+struct ship_pool_struct
+{
+  int *route, *routeStep, *hoursAtSea, *id, *cargoAmount;
+  bool *willMoveThisTimestep;
+  int *cell, *next_ship, *previous_ship;
+  int capacity, high_water_mark, number_ships, first_free;
+};
+
+extern struct ship_pool_struct ship_pool;
+
+void initialiseShipPool(int);
+int allocateShip();
+void releaseShip(int);
+void finaliseShipPool();
+
+#endif
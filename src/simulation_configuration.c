@@ -3,12 +3,40 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mpi.h"
 #include "simulation_configuration.h"
 
 #define MAX_LINE_LENGTH 128
+#define BINARY_CONFIGURATION_MAGIC 0x47464353
+#define BINARY_CONFIGURATION_VERSION 4
+// Largest number of bytes of the island bitmap sent in one broadcast
+#define BROADCAST_CHUNK_SIZE (1 << 30)
+
+// Header at the start of a configuration in the binary format, which holds the settings of the simulation. It is followed
+// by the X, Y and cargo of each port, and then the island bitmap
+struct binary_configuration_header_struct
+{
+  int magic, version;
+  int size_x, size_y, number_ports, number_islands, number_timesteps, dt, initialShips, reportStatsEvery;
+  int decomposition_dimensions, rebalanceEvery, checkpointEvery, telemetryEvery, performanceEvery, number_threads, seed;
+  int migrationMode;
+};
 
 static int getEntityNumber(char *);
-static bool getValueFromConfigurationString(char *, int *);
+static bool getKeyValueFromConfigurationString(char *, char *, int *);
+static void buildIslandBitmap(struct simulation_configuration_struct *);
+static long long getIslandBitmapSize(struct simulation_configuration_struct *);
+static long long getBinaryConfigurationSize(struct binary_configuration_header_struct *);
+static void allocatePorts(struct simulation_configuration_struct *, int);
+static void packConfigurationHeader(struct simulation_configuration_struct *, struct binary_configuration_header_struct *);
+static void unpackConfigurationHeader(struct binary_configuration_header_struct *, struct simulation_configuration_struct *);
+static int findPortHashSlot(struct simulation_configuration_struct *, long long);
+static bool isCellInDomain(struct simulation_configuration_struct *, int, int);
+static void stopWithConfigurationError();
 
 /*
 * A simple configuration file reader, I don't think you will need to change this (but feel free if you want to!)
@@ -19,8 +47,27 @@ static bool getValueFromConfigurationString(char *, int *);
 void parseConfiguration(char *filename, struct simulation_configuration_struct *simulation_configuration)
 {
   FILE *f = fopen(filename, "r");
-  char buffer[MAX_LINE_LENGTH], entity_copy[MAX_LINE_LENGTH];
+  char buffer[MAX_LINE_LENGTH], key[MAX_LINE_LENGTH];
   int value;
+  if (f == NULL)
+  {
+    fprintf(stderr, "Error, unable to open the configuration file '%s'\n", filename);
+    stopWithConfigurationError();
+  }
+  // Optional settings that need not appear in the configuration file
+  simulation_configuration->decomposition_dimensions = 1;
+  simulation_configuration->rebalanceEvery = 0;
+  simulation_configuration->checkpointEvery = 0;
+  simulation_configuration->telemetryEvery = 0;
+  simulation_configuration->performanceEvery = 0;
+  simulation_configuration->migrationMode = 0;
+  simulation_configuration->number_threads = 0;
+  simulation_configuration->seed = -1;
+  simulation_configuration->number_ports = 0;
+  simulation_configuration->number_islands = 0;
+  simulation_configuration->ports = NULL;
+  simulation_configuration->islands = NULL;
+  simulation_configuration->island_bitmap = NULL;
   while ((fgets(buffer, MAX_LINE_LENGTH, f)) != NULL)
   {
     // If the string ends with a newline then remove this to make parsing simpler
@@ -30,45 +77,55 @@ void parseConfiguration(char *filename, struct simulation_configuration_struct *
     {
       if (buffer[0] == '#')
         continue; // This line is a comment so ignore
-      if (getValueFromConfigurationString(buffer, &value))
+      if (getKeyValueFromConfigurationString(buffer, key, &value))
       {
-        if (strstr(buffer, "SIZE_X") != NULL)
+        // Keys are matched in full, so that one key which happens to contain another (e.g. DT) is not mistaken for it
+        if (strcmp(key, "SIZE_X") == 0)
           simulation_configuration->size_x = value;
-        if (strstr(buffer, "SIZE_Y") != NULL)
+        else if (strcmp(key, "SIZE_Y") == 0)
           simulation_configuration->size_y = value;
-        if (strstr(buffer, "INITIAL_SHIPS") != NULL)
+        else if (strcmp(key, "INITIAL_SHIPS") == 0)
           simulation_configuration->initialShips = value;
-        if (strstr(buffer, "REPORT_STATS_EVERY") != NULL)
+        else if (strcmp(key, "REPORT_STATS_EVERY") == 0)
           simulation_configuration->reportStatsEvery = value;
-        if (strstr(buffer, "NUM_PORTS") != NULL)
-        {
-          simulation_configuration->number_ports = value;
-          simulation_configuration->ports = (struct port_configuration_struct *)malloc(sizeof(struct port_configuration_struct) * value);
-          for (int i = 0; i < value; i++)
-          {
-            simulation_configuration->ports[i].target_route_indexes = (int *)malloc(sizeof(int) * value);
-          }
-        }
-        if (strstr(buffer, "NUM_ISLANDS") != NULL)
+        else if (strcmp(key, "NUM_PORTS") == 0)
+          allocatePorts(simulation_configuration, value);
+        else if (strcmp(key, "NUM_ISLANDS") == 0)
         {
           simulation_configuration->number_islands = value;
           simulation_configuration->islands = (struct island_configuration_struct *)malloc(sizeof(struct island_configuration_struct) * value);
         }
-        if (strstr(buffer, "NUM_TIMESTEPS") != NULL)
+        else if (strcmp(key, "DECOMPOSITION_DIMENSIONS") == 0)
+          simulation_configuration->decomposition_dimensions = value;
+        else if (strcmp(key, "REBALANCE_EVERY") == 0)
+          simulation_configuration->rebalanceEvery = value;
+        else if (strcmp(key, "CHECKPOINT_EVERY") == 0)
+          simulation_configuration->checkpointEvery = value;
+        else if (strcmp(key, "TELEMETRY_EVERY") == 0)
+          simulation_configuration->telemetryEvery = value;
+        else if (strcmp(key, "PERFORMANCE_EVERY") == 0)
+          simulation_configuration->performanceEvery = value;
+        else if (strcmp(key, "MIGRATION_MODE") == 0)
+          simulation_configuration->migrationMode = value;
+        else if (strcmp(key, "NUM_THREADS") == 0)
+          simulation_configuration->number_threads = value;
+        else if (strcmp(key, "SEED") == 0)
+          simulation_configuration->seed = value;
+        else if (strcmp(key, "NUM_TIMESTEPS") == 0)
           simulation_configuration->number_timesteps = value;
-        if (strstr(buffer, "DT") != NULL)
+        else if (strcmp(key, "DT") == 0)
           simulation_configuration->dt = value;
-        if (strstr(buffer, "PORT_") != NULL)
+        else if (strncmp(key, "PORT_", 5) == 0)
         {
-          strcpy(entity_copy, buffer);
-          int portNumber = getEntityNumber(entity_copy);
-          if (portNumber >= 0)
+          int portNumber = getEntityNumber(key);
+          char *field = strrchr(key, '_');
+          if (portNumber >= 0 && portNumber < simulation_configuration->number_ports)
           {
-            if (strstr(buffer, "_X") != NULL)
+            if (strcmp(field, "_X") == 0)
               simulation_configuration->ports[portNumber].x = value;
-            if (strstr(buffer, "_Y") != NULL)
+            else if (strcmp(field, "_Y") == 0)
               simulation_configuration->ports[portNumber].y = value;
-            if (strstr(buffer, "_CARGO") != NULL)
+            else if (strcmp(field, "_CARGO") == 0)
               simulation_configuration->ports[portNumber].cargo = value;
           }
           else
@@ -76,15 +133,15 @@ void parseConfiguration(char *filename, struct simulation_configuration_struct *
             fprintf(stderr, "Ignoring port configuration line '%s' as this is malformed and can not extract port number\n", buffer);
           }
         }
-        if (strstr(buffer, "ISLAND_") != NULL)
+        else if (strncmp(key, "ISLAND_", 7) == 0)
         {
-          strcpy(entity_copy, buffer);
-          int islandNumber = getEntityNumber(entity_copy);
-          if (islandNumber >= 0)
+          int islandNumber = getEntityNumber(key);
+          char *field = strrchr(key, '_');
+          if (islandNumber >= 0 && islandNumber < simulation_configuration->number_islands)
           {
-            if (strstr(buffer, "_X") != NULL)
+            if (strcmp(field, "_X") == 0)
               simulation_configuration->islands[islandNumber].x = value;
-            if (strstr(buffer, "_Y") != NULL)
+            else if (strcmp(field, "_Y") == 0)
               simulation_configuration->islands[islandNumber].y = value;
           }
           else
@@ -92,6 +149,10 @@ void parseConfiguration(char *filename, struct simulation_configuration_struct *
             fprintf(stderr, "Ignoring port configuration line '%s' as this is malformed and can not extract island number\n", buffer);
           }
         }
+        else
+        {
+          fprintf(stderr, "Ignoring configuration line '%s' as the key is not recognised\n", buffer);
+        }
       }
       else
       {
@@ -102,40 +163,304 @@ void parseConfiguration(char *filename, struct simulation_configuration_struct *
   fclose(f);
 }
 
-// Given the simulation configuration and a cell's X and Y location this will determine whether a port occupies that
-// cell or not
-bool isCellAPort(struct simulation_configuration_struct *config, int x, int y)
+// Reads the configuration from a file in either the text or the binary format, which is told apart by the magic number at
+// the start of a binary file. The island bitmap is always built, so that the islands can be shared by broadcastConfiguration.
+// Ships always sail to a port other than the one they leave, so there must be at least two ports
+void readConfiguration(char *filename, struct simulation_configuration_struct *simulation_configuration)
+{
+  int magic = 0;
+  FILE *f = fopen(filename, "rb");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Error, unable to open the configuration file '%s'\n", filename);
+    stopWithConfigurationError();
+  }
+  if (fread(&magic, sizeof(int), 1, f) != 1)
+    magic = 0;
+  fclose(f);
+
+  if (magic == BINARY_CONFIGURATION_MAGIC)
+  {
+    loadBinaryConfiguration(filename, simulation_configuration);
+  }
+  else
+  {
+    parseConfiguration(filename, simulation_configuration);
+    buildIslandBitmap(simulation_configuration);
+  }
+  if (simulation_configuration->number_ports < 2)
+  {
+    fprintf(stderr, "Error, the configuration '%s' has %d ports, but at least two are needed for ships to sail between\n", filename,
+            simulation_configuration->number_ports);
+    stopWithConfigurationError();
+  }
+}
+
+// Loads a configuration in the binary format, as written by writeBinaryConfiguration. The file is memory mapped rather than
+// read, and the island bitmap is used in place from the mapping (which is never unmapped), so loading takes time in
+// proportion to the number of ports rather than the number of islands
+void loadBinaryConfiguration(char *filename, struct simulation_configuration_struct *simulation_configuration)
+{
+  struct stat file_status;
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1 || fstat(fd, &file_status) != 0)
+  {
+    fprintf(stderr, "Error, unable to open the binary configuration file '%s'\n", filename);
+    stopWithConfigurationError();
+  }
+  unsigned char *contents = (unsigned char *)mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (contents == MAP_FAILED || file_status.st_size < (off_t)sizeof(struct binary_configuration_header_struct))
+  {
+    fprintf(stderr, "Error, unable to map the binary configuration file '%s'\n", filename);
+    stopWithConfigurationError();
+  }
+
+  struct binary_configuration_header_struct *header = (struct binary_configuration_header_struct *)contents;
+  if (header->magic != BINARY_CONFIGURATION_MAGIC || header->version != BINARY_CONFIGURATION_VERSION ||
+      file_status.st_size < getBinaryConfigurationSize(header))
+  {
+    fprintf(stderr, "Error, '%s' is not a complete binary configuration written by this version of the simulation\n", filename);
+    stopWithConfigurationError();
+  }
+  unpackConfigurationHeader(header, simulation_configuration);
+  simulation_configuration->islands = NULL;
+
+  int *port_values = (int *)(contents + sizeof(struct binary_configuration_header_struct));
+  allocatePorts(simulation_configuration, header->number_ports);
+  for (int i = 0; i < header->number_ports; i++)
+  {
+    simulation_configuration->ports[i].x = port_values[i * 3];
+    simulation_configuration->ports[i].y = port_values[i * 3 + 1];
+    simulation_configuration->ports[i].cargo = port_values[i * 3 + 2];
+  }
+  simulation_configuration->island_bitmap = (unsigned char *)&port_values[header->number_ports * 3];
+}
+
+// Writes a configuration in the binary format, which is a header holding the settings, followed by the X, Y and cargo of
+// each port and then the island bitmap. The island bitmap must have been built
+void writeBinaryConfiguration(char *filename, struct simulation_configuration_struct *simulation_configuration)
 {
+  struct binary_configuration_header_struct header;
+  FILE *f = fopen(filename, "wb");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Error, unable to open '%s' to write the binary configuration\n", filename);
+    stopWithConfigurationError();
+  }
+  packConfigurationHeader(simulation_configuration, &header);
+  fwrite(&header, sizeof(struct binary_configuration_header_struct), 1, f);
+  for (int i = 0; i < simulation_configuration->number_ports; i++)
+  {
+    int port_values[3] = {simulation_configuration->ports[i].x, simulation_configuration->ports[i].y, simulation_configuration->ports[i].cargo};
+    fwrite(port_values, sizeof(int), 3, f);
+  }
+  fwrite(simulation_configuration->island_bitmap, sizeof(unsigned char), getIslandBitmapSize(simulation_configuration), f);
+  fclose(f);
+}
+
+// Sends the configuration read by the root process to every other process, which saves each process from reading the
+// file. Only the settings, ports and island bitmap are sent, the list of islands is not as the bitmap replaces it. Every
+// process must call this together
+void broadcastConfiguration(struct simulation_configuration_struct *simulation_configuration, int root)
+{
+  int myrank;
+  struct binary_configuration_header_struct header;
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if (myrank == root)
+    packConfigurationHeader(simulation_configuration, &header);
+  MPI_Bcast(&header, sizeof(struct binary_configuration_header_struct) / sizeof(int), MPI_INT, root, MPI_COMM_WORLD);
+
+  int *port_values = (int *)malloc(sizeof(int) * (header.number_ports * 3 + 1));
+  if (myrank == root)
+  {
+    for (int i = 0; i < header.number_ports; i++)
+    {
+      port_values[i * 3] = simulation_configuration->ports[i].x;
+      port_values[i * 3 + 1] = simulation_configuration->ports[i].y;
+      port_values[i * 3 + 2] = simulation_configuration->ports[i].cargo;
+    }
+  }
+  else
+  {
+    unpackConfigurationHeader(&header, simulation_configuration);
+    simulation_configuration->islands = NULL;
+    allocatePorts(simulation_configuration, header.number_ports);
+    simulation_configuration->island_bitmap = (unsigned char *)malloc(getIslandBitmapSize(simulation_configuration));
+  }
+  MPI_Bcast(port_values, header.number_ports * 3, MPI_INT, root, MPI_COMM_WORLD);
+  // The bitmap of a large domain can exceed the largest count of a single message, so it is sent in pieces
+  long long bitmap_size = getIslandBitmapSize(simulation_configuration);
+  for (long long sent = 0; sent < bitmap_size; sent += BROADCAST_CHUNK_SIZE)
+  {
+    int chunk = (int)(bitmap_size - sent < BROADCAST_CHUNK_SIZE ? bitmap_size - sent : BROADCAST_CHUNK_SIZE);
+    MPI_Bcast(&simulation_configuration->island_bitmap[sent], chunk, MPI_UNSIGNED_CHAR, root, MPI_COMM_WORLD);
+  }
+  if (myrank != root)
+  {
+    for (int i = 0; i < header.number_ports; i++)
+    {
+      simulation_configuration->ports[i].x = port_values[i * 3];
+      simulation_configuration->ports[i].y = port_values[i * 3 + 1];
+      simulation_configuration->ports[i].cargo = port_values[i * 3 + 2];
+    }
+  }
+  free(port_values);
+}
+
+// Builds the lookups of which cells are occupied by islands and ports, so that the functions below take constant time
+// rather than scanning every island and port. This must be called on every process once the configuration has been read
+// (and broadcast), islands and ports outside of the domain are left out as no cell will ever be looked up there
+void initialiseCellLookups(struct simulation_configuration_struct *config)
+{
+  if (config->island_bitmap == NULL)
+    buildIslandBitmap(config);
+
+  // The table is kept at most half full so that probe sequences stay short
+  config->port_hash_capacity = 1;
+  while (config->port_hash_capacity < config->number_ports * 2)
+    config->port_hash_capacity *= 2;
+  config->port_hash_cells = (long long *)malloc(sizeof(long long) * config->port_hash_capacity);
+  config->port_hash_indexes = (int *)malloc(sizeof(int) * config->port_hash_capacity);
+  for (int i = 0; i < config->port_hash_capacity; i++)
+    config->port_hash_cells[i] = -1;
   for (int i = 0; i < config->number_ports; i++)
   {
-    if (config->ports[i].x == x && config->ports[i].y == y)
-      return true;
+    if (isCellInDomain(config, config->ports[i].x, config->ports[i].y))
+    {
+      long long cell = (long long)config->ports[i].x * config->size_y + config->ports[i].y;
+      int slot = findPortHashSlot(config, cell);
+      // If two ports share a cell then the first one is used, as was the case when the ports were scanned in order
+      if (config->port_hash_cells[slot] == -1)
+      {
+        config->port_hash_cells[slot] = cell;
+        config->port_hash_indexes[slot] = i;
+      }
+    }
   }
-  return false;
+}
+
+// Given the simulation configuration and a cell's X and Y location this will determine whether a port occupies that
+// cell or not
+bool isCellAPort(struct simulation_configuration_struct *config, int x, int y)
+{
+  return getCellPortIndex(config, x, y) != -1;
 }
 
 // Given the simulation configuration and a cell's X and Y location this will return the index of the port that
 // lies at that location, or altertively -1 if there is no port there.
 int getCellPortIndex(struct simulation_configuration_struct *config, int x, int y)
 {
-  for (int i = 0; i < config->number_ports; i++)
-  {
-    if (config->ports[i].x == x && config->ports[i].y == y)
-      return i;
-  }
-  return -1;
+  if (!isCellInDomain(config, x, y))
+    return -1;
+  long long cell = (long long)x * config->size_y + y;
+  int slot = findPortHashSlot(config, cell);
+  return config->port_hash_cells[slot] == cell ? config->port_hash_indexes[slot] : -1;
 }
 
 // Given the simulation configuration and a cell's X and Y location this will determine whether an island occupies that
 // cell or not
 bool isCellAnIsland(struct simulation_configuration_struct *config, int x, int y)
 {
+  if (!isCellInDomain(config, x, y))
+    return false;
+  long long cell = (long long)x * config->size_y + y;
+  return (config->island_bitmap[cell / 8] >> (cell % 8)) & 1;
+}
+
+// Returns the slot in the port hash table that holds the cell provided, or the empty slot where it would be inserted
+static int findPortHashSlot(struct simulation_configuration_struct *config, long long cell)
+{
+  int slot = (int)(((unsigned long long)cell * 0x9E3779B97F4A7C15ULL) >> 40) & (config->port_hash_capacity - 1);
+  while (config->port_hash_cells[slot] != -1 && config->port_hash_cells[slot] != cell)
+    slot = (slot + 1) & (config->port_hash_capacity - 1);
+  return slot;
+}
+
+// Builds the bitmap of cells occupied by islands from the list of islands
+static void buildIslandBitmap(struct simulation_configuration_struct *config)
+{
+  config->island_bitmap = (unsigned char *)calloc(getIslandBitmapSize(config), sizeof(unsigned char));
   for (int i = 0; i < config->number_islands; i++)
   {
-    if (config->islands[i].x == x && config->islands[i].y == y)
-      return true;
+    if (isCellInDomain(config, config->islands[i].x, config->islands[i].y))
+    {
+      long long cell = (long long)config->islands[i].x * config->size_y + config->islands[i].y;
+      config->island_bitmap[cell / 8] |= (unsigned char)(1 << (cell % 8));
+    }
   }
-  return false;
+}
+
+// Returns the number of bytes in the island bitmap, one bit per cell of the global domain
+static long long getIslandBitmapSize(struct simulation_configuration_struct *config)
+{
+  return ((long long)config->size_x * config->size_y + 7) / 8;
+}
+
+// Returns the number of bytes in a binary configuration with the header provided
+static long long getBinaryConfigurationSize(struct binary_configuration_header_struct *header)
+{
+  return (long long)sizeof(struct binary_configuration_header_struct) + (long long)header->number_ports * 3 * sizeof(int) +
+         ((long long)header->size_x * header->size_y + 7) / 8;
+}
+
+// Sets up space for the number of ports provided, each with space for its route indexes to every other port
+static void allocatePorts(struct simulation_configuration_struct *config, int number_ports)
+{
+  config->number_ports = number_ports;
+  config->ports = (struct port_configuration_struct *)malloc(sizeof(struct port_configuration_struct) * number_ports);
+  for (int i = 0; i < number_ports; i++)
+    config->ports[i].target_route_indexes = (int *)malloc(sizeof(int) * number_ports);
+}
+
+// Copies the settings of the configuration into the header of the binary format
+static void packConfigurationHeader(struct simulation_configuration_struct *config, struct binary_configuration_header_struct *header)
+{
+  header->magic = BINARY_CONFIGURATION_MAGIC;
+  header->version = BINARY_CONFIGURATION_VERSION;
+  header->size_x = config->size_x;
+  header->size_y = config->size_y;
+  header->number_ports = config->number_ports;
+  header->number_islands = config->number_islands;
+  header->number_timesteps = config->number_timesteps;
+  header->dt = config->dt;
+  header->initialShips = config->initialShips;
+  header->reportStatsEvery = config->reportStatsEvery;
+  header->decomposition_dimensions = config->decomposition_dimensions;
+  header->rebalanceEvery = config->rebalanceEvery;
+  header->checkpointEvery = config->checkpointEvery;
+  header->telemetryEvery = config->telemetryEvery;
+  header->performanceEvery = config->performanceEvery;
+  header->migrationMode = config->migrationMode;
+  header->number_threads = config->number_threads;
+  header->seed = config->seed;
+}
+
+// Copies the settings from the header of the binary format into the configuration, the ports and islands are not set
+static void unpackConfigurationHeader(struct binary_configuration_header_struct *header, struct simulation_configuration_struct *config)
+{
+  config->size_x = header->size_x;
+  config->size_y = header->size_y;
+  config->number_ports = header->number_ports;
+  config->number_islands = header->number_islands;
+  config->number_timesteps = header->number_timesteps;
+  config->dt = header->dt;
+  config->initialShips = header->initialShips;
+  config->reportStatsEvery = header->reportStatsEvery;
+  config->decomposition_dimensions = header->decomposition_dimensions;
+  config->rebalanceEvery = header->rebalanceEvery;
+  config->checkpointEvery = header->checkpointEvery;
+  config->telemetryEvery = header->telemetryEvery;
+  config->performanceEvery = header->performanceEvery;
+  config->migrationMode = header->migrationMode;
+  config->number_threads = header->number_threads;
+  config->seed = header->seed;
+}
+
+// Returns whether a cell's X and Y location lies within the global domain
+static bool isCellInDomain(struct simulation_configuration_struct *config, int x, int y)
+{
+  return x >= 0 && x < config->size_x && y >= 0 && y < config->size_y;
 }
 
 // A helper function to parse a string with an underscore in it, this will extract the number after the underscore
@@ -155,19 +480,33 @@ static int getEntityNumber(char *sourceString)
   return -1;
 }
 
-// Given a string with a key-value pair (e.g. key = value) this will extract the value after the equals (it is assumed)
-// to be an integer and return this via the value pointer. It returns true if such extraction was possible and
-// false if not
-static bool getValueFromConfigurationString(char *sourceString, int *value)
+// Given a string with a key-value pair (e.g. key = value) this will extract the key before the equals, without any
+// surrounding spaces, into key and the value after the equals (it is assumed to be an integer) via the value pointer. It
+// returns true if such extraction was possible and false if not
+static bool getKeyValueFromConfigurationString(char *sourceString, char *key, int *value)
 {
   char *equalsLocation = strchr(sourceString, '=');
   if (equalsLocation == NULL)
-  {
     return false;
-  }
-  else
-  {
-    *value = atoi(&equalsLocation[1]);
-    return true;
-  }
+  char *start = sourceString, *end = equalsLocation;
+  while (start < end && isspace(*start))
+    start++;
+  while (end > start && isspace(end[-1]))
+    end--;
+  memcpy(key, start, end - start);
+  key[end - start] = '\0';
+  *value = atoi(&equalsLocation[1]);
+  return true;
+}
+
+// Stops after an error in reading or writing a configuration. Within the simulation only process 0 reads the configuration
+// whilst the others wait for it to be broadcast, so every process is aborted rather than just this one exiting. The tools
+// that read configurations do not use MPI, so they just exit
+static void stopWithConfigurationError()
+{
+  int initialised;
+  MPI_Initialized(&initialised);
+  if (initialised)
+    MPI_Abort(MPI_COMM_WORLD, -1);
+  exit(-1);
 }
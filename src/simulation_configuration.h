@@ -26,12 +26,36 @@ struct simulation_configuration_struct
   // dt = Number of hours between each timestep, for instance if this is 10 then each timestep will advance the clock by 10 hours
   // initialShips = Number of initial ships
   // reportStatsEvery = Frequency (in timesteps) that statistics should be reported
+  // decomposition_dimensions = Whether the domain is split over processes as strips along X (1) or as 2D blocks (2)
+  // rebalanceEvery = Frequency (in timesteps) that the sub-domains are rebalanced by ship work, zero to never rebalance
+  // number_threads = Number of threads per process, zero to take this from OMP_NUM_THREADS
+  // checkpointEvery = Frequency (in timesteps) that the state of the simulation is checkpointed, zero to never checkpoint
+  // telemetryEvery = Frequency (in timesteps) that the state of the ports and ships is recorded to the telemetry file, zero to
+  // never record it
+  // performanceEvery = Frequency (in timesteps) that the phase timers and counters of each process are recorded to the
+  // performance file, zero to only report their totals at the end of the run
+  // migrationMode = How ships are sent to the neighbouring processes, two sided messages (0) or one sided puts (1)
+  // seed = Seed of the random numbers, runs with the same seed give the same results, -1 to pick one from the clock
+  // islands = The islands as listed in a text configuration, NULL where the configuration was loaded as a binary or broadcast
+  // island_bitmap = One bit per cell of the global domain (indexed by x * size_y + y), set if an island occupies the cell
+  // port_hash_cells, port_hash_indexes = Open addressing hash table from a cell (x * size_y + y, -1 for an empty slot) to
+  // the index of the port occupying it, with port_hash_capacity slots (a power of two)
   int size_x, size_y, number_ports, number_islands, number_timesteps, dt, initialShips, reportStatsEvery;
+  int decomposition_dimensions, rebalanceEvery, checkpointEvery, telemetryEvery, performanceEvery, migrationMode;
+  int number_threads, seed;
   struct port_configuration_struct *ports;
   struct island_configuration_struct *islands;
+  unsigned char *island_bitmap;
+  long long *port_hash_cells;
+  int *port_hash_indexes, port_hash_capacity;
 };
 
 void parseConfiguration(char *, struct simulation_configuration_struct *);
+void readConfiguration(char *, struct simulation_configuration_struct *);
+void loadBinaryConfiguration(char *, struct simulation_configuration_struct *);
+void writeBinaryConfiguration(char *, struct simulation_configuration_struct *);
+void broadcastConfiguration(struct simulation_configuration_struct *, int);
+void initialiseCellLookups(struct simulation_configuration_struct *);
 bool isCellAPort(struct simulation_configuration_struct *, int, int);
 int getCellPortIndex(struct simulation_configuration_struct *, int, int);
 bool isCellAnIsland(struct simulation_configuration_struct *, int, int);
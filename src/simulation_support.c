@@ -1,52 +1,164 @@
-#include <time.h>
-#include <stdlib.h>
 #include "simulation_support.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-// Initialises the simulation support by seeding the random number generator. Note if you do not do this
-// then it will mean you random numbers are predictably chosen (i.e. the same) each run
-void initialiseSimulationSupport()
+// Each decision draws from its own stream, so that for instance whether a ship moves never shares random numbers with
+// whether it is removed
+#define STREAM_CREATE_SHIP 1
+#define STREAM_REMOVE_SHIP 2
+#define STREAM_SHIP_MOVE 3
+#define STREAM_TARGET_PORT 4
+
+static unsigned int simulation_seed;
+
+static unsigned int getRandomNumber(unsigned int, unsigned int, unsigned int, unsigned int);
+static unsigned int mixBits(unsigned int);
+static int getRandomBelow(unsigned int, int);
+static bool decideShipMove(int, unsigned int);
+#ifdef __AVX2__
+static __m256i mixBitsAVX2(__m256i);
+static __m256i getRandomBelowAVX2(__m256i, int);
+#endif
+
+// Initialises the simulation support with the seed of the random number generator. The random numbers are not held in
+// any shared state, each is a hash of the seed along with what is being decided, who for (the ship or port) and the
+// timestep. Hence the same seed gives the same simulation whatever the number of processes and threads, and the
+// decisions can be made concurrently
+void initialiseSimulationSupport(unsigned int seed)
 {
-  srand(time(NULL));
+  simulation_seed = seed;
 }
 
 // Based on the number of ships in the past hundred hours, this will determine whether a new ship
-// should be created or not
-bool shouldCreateNewShip(int shipsInPastHundredHours)
+// should be created or not at a specific port in a specific timestep
+bool shouldCreateNewShip(int shipsInPastHundredHours, int port, int timestep)
 {
   if (shipsInPastHundredHours < 10)
     return false;
-  return rand() % 30 < shipsInPastHundredHours;
+  return getRandomBelow(getRandomNumber(STREAM_CREATE_SHIP, port, timestep, 0), 30) < shipsInPastHundredHours;
 }
 
 // Given the hours at sea that a ship has endured, this will return whether that ship should
-// be removed or not
-bool shouldRemoveShip(int hoursAtSea)
+// be removed or not in a specific timestep
+bool shouldRemoveShip(int hoursAtSea, int shipId, int timestep)
 {
   if (hoursAtSea < 100)
     return false;
-  return (rand() % 6 == 0);
+  return getRandomBelow(getRandomNumber(STREAM_REMOVE_SHIP, shipId, timestep, 0), 6) == 0;
 }
 
-// Given the number of hours at sea that a ship has endured and the number of ships in the current cell,
-// this will determine whether that ship should move in this timestep or not.
-bool willShipMove(int numberShipsInCell)
+// Given the number of ships in the current cell, this will determine whether a specific ship should move in this
+// timestep or not.
+bool willShipMove(int numberShipsInCell, int shipId, int timestep)
 {
   if (numberShipsInCell < 4)
     return true;
-  if (numberShipsInCell > rand() % 20 && rand() % 2 == 0)
+  if (numberShipsInCell > getRandomBelow(getRandomNumber(STREAM_SHIP_MOVE, shipId, timestep, 0), 20) &&
+      getRandomBelow(getRandomNumber(STREAM_SHIP_MOVE, shipId, timestep, 1), 2) == 0)
     return false;
   return true;
 }
 
-// Generates a target point index for a ship based on the total number of ports and the current
-// port that it resides in (note that this will never be the current port, it is guaranteed to be moving
-// to a different port)
-int getTargetPort(int numberPorts, int currentPort)
+// Decides whether each of a batch of ships will move in a specific timestep, as willShipMove does for one ship, given the
+// number of ships in the cell of each and their ids. The decisions are written into willMove. The two random numbers of
+// each ship share the hashing of the seed, stream, ship and timestep, and with AVX2 eight ships are decided at once,
+// otherwise the loop is written so that the compiler can vectorise it
+void willShipsMove(int numberShips, int *numberShipsInCell, int *shipIds, int timestep, bool *willMove)
 {
-  int r = rand() % numberPorts;
-  while (r == currentPort)
+  unsigned int streamKey = mixBits(simulation_seed + STREAM_SHIP_MOVE * 0x9e3779b9U);
+  int i = 0;
+#ifdef __AVX2__
+  __m256i stream_key = _mm256_set1_epi32((int)streamKey), timestep_key = _mm256_set1_epi32(timestep);
+  __m256i four = _mm256_set1_epi32(4), one = _mm256_set1_epi32(1);
+  for (; i + 8 <= numberShips; i += 8)
   {
-    r = rand() % numberPorts;
+    __m256i ships_in_cell = _mm256_loadu_si256((__m256i *)&numberShipsInCell[i]);
+    __m256i ship_ids = _mm256_loadu_si256((__m256i *)&shipIds[i]);
+    __m256i key = mixBitsAVX2(_mm256_xor_si256(mixBitsAVX2(_mm256_xor_si256(stream_key, ship_ids)), timestep_key));
+    __m256i crowding = getRandomBelowAVX2(mixBitsAVX2(key), 20);
+    __m256i halves = mixBitsAVX2(_mm256_xor_si256(key, one));
+    // A ship stays put if its cell holds at least four ships, more than the first draw and the top bit of the second is clear
+    __m256i stays = _mm256_andnot_si256(_mm256_cmpgt_epi32(four, ships_in_cell), _mm256_cmpgt_epi32(ships_in_cell, crowding));
+    stays = _mm256_and_si256(stays, _mm256_cmpgt_epi32(halves, _mm256_set1_epi32(-1)));
+    int stay_mask = _mm256_movemask_ps(_mm256_castsi256_ps(stays));
+    for (int j = 0; j < 8; j++)
+      willMove[i + j] = ((stay_mask >> j) & 1) == 0;
   }
+#endif
+#pragma omp simd
+  for (int j = i; j < numberShips; j++)
+    willMove[j] = decideShipMove(numberShipsInCell[j], mixBits(mixBits(streamKey ^ (unsigned int)shipIds[j]) ^ (unsigned int)timestep));
+}
+
+// Generates a target point index for a ship based on the total number of ports and the current
+// port that it resides in (note that this will never be the current port, it is guaranteed to be moving
+// to a different port). One of the other ports is picked directly, rather than redrawing until it differs, so there must be
+// at least two ports, which readConfiguration makes sure of
+int getTargetPort(int numberPorts, int currentPort, int shipId, int timestep)
+{
+  int r = getRandomBelow(getRandomNumber(STREAM_TARGET_PORT, shipId, timestep, 0), numberPorts - 1);
+  if (r >= currentPort)
+    r++;
   return r;
-}
\ No newline at end of file
+}
+
+// Returns the random number for a draw within a stream, keyed on the ship (or port) and timestep. This is a counter
+// based generator, the seed and each part of the key are folded in turn through an integer hash
+static unsigned int getRandomNumber(unsigned int stream, unsigned int key, unsigned int timestep, unsigned int draw)
+{
+  unsigned int x = mixBits(simulation_seed + stream * 0x9e3779b9U);
+  x = mixBits(x ^ key);
+  x = mixBits(x ^ timestep);
+  return mixBits(x ^ draw);
+}
+
+// Mixes the bits of a 32 bit integer so that each input bit affects every output bit (the lowbias32 hash), it is only
+// shifts, xors and multiplies so the compiler can vectorise loops that call it
+static unsigned int mixBits(unsigned int x)
+{
+  x ^= x >> 16;
+  x *= 0x7feb352dU;
+  x ^= x >> 15;
+  x *= 0x846ca68bU;
+  x ^= x >> 16;
+  return x;
+}
+
+// Maps a random number onto 0 to n-1 by multiplying and keeping the top half, which avoids the division of a modulo
+static int getRandomBelow(unsigned int x, int n)
+{
+  return (int)(((unsigned long long)x * (unsigned int)n) >> 32);
+}
+
+// Decides whether a ship will move as willShipMove does, given the hash of the seed, stream, ship and timestep that its
+// draws are taken from
+static bool decideShipMove(int numberShipsInCell, unsigned int key)
+{
+  if (numberShipsInCell < 4)
+    return true;
+  return !(numberShipsInCell > getRandomBelow(mixBits(key), 20) && getRandomBelow(mixBits(key ^ 1), 2) == 0);
+}
+
+#ifdef __AVX2__
+// Mixes the bits of eight 32 bit integers at once, as mixBits does for one
+static __m256i mixBitsAVX2(__m256i x)
+{
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+  x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846ca68bU));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+  return x;
+}
+
+// Maps eight random numbers onto 0 to n-1 at once, as getRandomBelow does for one. The 64 bit products of the even and
+// odd lanes are formed separately and the top half of each is kept
+static __m256i getRandomBelowAVX2(__m256i x, int n)
+{
+  __m256i multiplier = _mm256_set1_epi32(n);
+  __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, multiplier), 32);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), multiplier);
+  return _mm256_blend_epi32(even, odd, 0xaa);
+}
+#endif
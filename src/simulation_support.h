@@ -3,10 +3,11 @@
 
 #include <stdbool.h>
 
-void initialiseSimulationSupport();
-bool shouldCreateNewShip(int);
-bool shouldRemoveShip(int);
-bool willShipMove(int);
-int getTargetPort(int, int);
+void initialiseSimulationSupport(unsigned int);
+bool shouldCreateNewShip(int, int, int);
+bool shouldRemoveShip(int, int, int);
+bool willShipMove(int, int, int);
+void willShipsMove(int, int *, int *, int, bool *);
+int getTargetPort(int, int, int, int);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include "mpi.h"
+#include "statistics.h"
+
+static MPI_Datatype statistics_type;
+static MPI_Op statistics_op;
+static MPI_Request statistics_request = MPI_REQUEST_NULL;
+// The report being combined, its statistics from this process and the result on process 0, along with when it was taken
+static struct statistics_struct local_statistics, global_statistics;
+static int report_hours;
+
+static void combineStatistics(void *, void *, int *, MPI_Datatype *);
+
+// Sets up the data type and reduction operation that combine the statistics of every process in one go
+void initialiseStatistics()
+{
+  MPI_Type_contiguous(sizeof(struct statistics_struct) / sizeof(long long), MPI_LONG_LONG, &statistics_type);
+  MPI_Type_commit(&statistics_type);
+  MPI_Op_create(combineStatistics, 1, &statistics_op);
+}
+
+// Starts combining the statistics of every process onto process 0 for a report at the hours provided, without waiting for
+// this to complete. The report is printed when the next one is started (or when the reports are finalised), so that the
+// reduction overlaps with the timesteps in between. Every process must call this together
+void startStatisticsReport(struct statistics_struct *statistics, int hours)
+{
+  completeStatisticsReport();
+  local_statistics = *statistics;
+  report_hours = hours;
+  MPI_Ireduce(&local_statistics, &global_statistics, 1, statistics_type, statistics_op, 0, MPI_COMM_WORLD, &statistics_request);
+}
+
+// Waits for the report that is being combined, if there is one, and prints it on process 0
+void completeStatisticsReport()
+{
+  int myrank;
+  if (statistics_request == MPI_REQUEST_NULL)
+    return;
+  MPI_Wait(&statistics_request, MPI_STATUS_IGNORE);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  if (myrank == 0)
+  {
+    printf("======= Report at %d hours =======\n", report_hours);
+    printf("%lld ships at sea, %lld ships in port, %lld tonnes in transit\n", global_statistics.shipsAtSea,
+           global_statistics.shipsInPort, global_statistics.cargoInTransit);
+    printf("%lld ships migrated between processes, at most %lld ships in a cell\n", global_statistics.migratingShips,
+           global_statistics.maxShipsInCell);
+  }
+}
+
+// Prints the last report and frees the data type and reduction operation
+void finaliseStatistics()
+{
+  completeStatisticsReport();
+  MPI_Op_free(&statistics_op);
+  MPI_Type_free(&statistics_type);
+}
+
+// The reduction operation, which combines the statistics of one process (in) into those of another (inout). Each
+// statistic is summed apart from the maximums, further statistics must be combined here too
+static void combineStatistics(void *in, void *inout, int *len, MPI_Datatype *datatype)
+{
+  struct statistics_struct *source = (struct statistics_struct *)in;
+  struct statistics_struct *target = (struct statistics_struct *)inout;
+  (void)datatype; // The operation is only ever used with statistics_type, so each element is a whole statistics_struct
+  for (int i = 0; i < *len; i++)
+  {
+    target[i].shipsAtSea += source[i].shipsAtSea;
+    target[i].shipsInPort += source[i].shipsInPort;
+    target[i].cargoInTransit += source[i].cargoInTransit;
+    target[i].migratingShips += source[i].migratingShips;
+    if (source[i].maxShipsInCell > target[i].maxShipsInCell)
+      target[i].maxShipsInCell = source[i].maxShipsInCell;
+  }
+}
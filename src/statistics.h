@@ -0,0 +1,20 @@
+#ifndef STATISTICS_INCLUDE
+#define STATISTICS_INCLUDE
+
+// Statistics of the simulation reported periodically, which each process measures over what it holds and are then
+// combined over every process in a single reduction
+// shipsAtSea, shipsInPort, cargoInTransit = summed over the processes
+// migratingShips = ships that have moved between processes since the last report, summed over the processes
+// maxShipsInCell = the most ships in any one cell, the maximum over the processes
+struct statistics_struct
+{
+  long long shipsAtSea, shipsInPort, cargoInTransit, migratingShips;
+  long long maxShipsInCell;
+};
+
+void initialiseStatistics();
+void startStatisticsReport(struct statistics_struct *, int);
+void completeStatisticsReport();
+void finaliseStatistics();
+
+#endif
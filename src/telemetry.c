@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mpi.h"
+#include "telemetry.h"
+
+// Rows are sent to process 0 and written out in batches of this many
+#define TELEMETRY_BATCH_ROWS 64
+// Number of per port columns (ships in port, cargo shipped and cargo arrived), which are held one after another
+#define PORT_METRICS 3
+
+// What is in flight for a batch, once filled by every process it is reduced onto process 0, which then writes it to the
+// file. Whilst process 0 is writing, the batch can already be filled again as the writes are from separate buffers
+#define BATCH_IDLE 0
+#define BATCH_REDUCING 1
+#define BATCH_WRITING 2
+
+// A batch of rows of telemetry, two of these are used in turn so that one can be filled whilst the other is still being
+// reduced and written, hence the cost of the communication and file access is hidden behind the timesteps
+// first_row, number_rows = rows of the file that this batch holds
+// port_values = the values of the per port columns for the ports owned by this process (zero for the rest), indexed by
+// [metric][row][port], and ships_at_sea = ships at sea held by this process in each row
+// reduced_port_values, gathered_ships_at_sea = the batch of every process combined onto process 0 (indexed by
+// [process][row] for the ships at sea), then hours and ships_at_sea_rows are the hours of each row and the ships at sea
+// rearranged into rows, which process 0 writes from
+struct telemetry_batch_struct
+{
+  int first_row, number_rows, state;
+  int *port_values, *ships_at_sea, *hours;
+  int *reduced_port_values, *gathered_ships_at_sea, *ships_at_sea_rows;
+  MPI_Request collective_requests[2];
+  MPI_Request write_requests[TELEMETRY_COLUMNS];
+};
+
+static struct telemetry_header_struct header;
+static struct telemetry_batch_struct batches[2];
+static int current_batch, myrank, size;
+static MPI_File telemetry_file;
+
+static void flushBatch();
+static void startBatchWrites(struct telemetry_batch_struct *);
+static void waitForBatch(struct telemetry_batch_struct *);
+static void resetBatch(struct telemetry_batch_struct *, int);
+static void setColumn(int, char *, int, long long *);
+
+// Sets up the telemetry, which records the state of the ports and the ships at sea held by each process every few
+// timesteps from the first timestep until the end of the run, and creates the file that process 0 writes this into
+// (replacing any file of that name). Every process must call this together
+void initialiseTelemetry(char *filename, int number_ports, int first_timestep, int number_timesteps, int every, int dt)
+{
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // Rows are recorded at timesteps that are a multiple of every, as with the statistics reported to the screen
+  memset(&header, 0, sizeof(struct telemetry_header_struct));
+  header.magic = TELEMETRY_MAGIC;
+  header.version = TELEMETRY_VERSION;
+  header.number_ports = number_ports;
+  header.number_processes = size;
+  header.first_timestep = ((first_timestep + every - 1) / every) * every;
+  header.number_rows = header.first_timestep < number_timesteps ? (number_timesteps - header.first_timestep + every - 1) / every : 0;
+  header.every = every;
+  header.dt = dt;
+  long long offset = sizeof(struct telemetry_header_struct);
+  setColumn(TELEMETRY_HOURS, "hours", 1, &offset);
+  setColumn(TELEMETRY_SHIPS_IN_PORT, "ships_in_port", number_ports, &offset);
+  setColumn(TELEMETRY_CARGO_SHIPPED, "cargo_shipped", number_ports, &offset);
+  setColumn(TELEMETRY_CARGO_ARRIVED, "cargo_arrived", number_ports, &offset);
+  setColumn(TELEMETRY_SHIPS_AT_SEA, "ships_at_sea", size, &offset);
+
+  for (int i = 0; i < 2; i++)
+  {
+    batches[i].port_values = (int *)malloc(sizeof(int) * PORT_METRICS * TELEMETRY_BATCH_ROWS * (number_ports + 1));
+    batches[i].ships_at_sea = (int *)malloc(sizeof(int) * TELEMETRY_BATCH_ROWS);
+    batches[i].hours = (int *)malloc(sizeof(int) * TELEMETRY_BATCH_ROWS);
+    batches[i].reduced_port_values = (int *)malloc(sizeof(int) * PORT_METRICS * TELEMETRY_BATCH_ROWS * (number_ports + 1));
+    batches[i].gathered_ships_at_sea = (int *)malloc(sizeof(int) * TELEMETRY_BATCH_ROWS * size);
+    batches[i].ships_at_sea_rows = (int *)malloc(sizeof(int) * TELEMETRY_BATCH_ROWS * size);
+    for (int j = 0; j < TELEMETRY_COLUMNS; j++)
+      batches[i].write_requests[j] = MPI_REQUEST_NULL;
+    batches[i].state = BATCH_IDLE;
+    resetBatch(&batches[i], 0);
+  }
+  current_batch = 0;
+
+  if (myrank == 0)
+  {
+    if (MPI_File_open(MPI_COMM_SELF, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &telemetry_file) != MPI_SUCCESS)
+    {
+      fprintf(stderr, "Error, unable to open the telemetry file '%s'\n", filename);
+      MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+    MPI_File_set_size(telemetry_file, 0);
+    MPI_File_write_at(telemetry_file, 0, &header, sizeof(struct telemetry_header_struct), MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+}
+
+// Records the state of a port owned by this process in the row being built, which recordTelemetry then completes
+void recordTelemetryPort(int port_index, int ships_in_port, int cargo_shipped, int cargo_arrived)
+{
+  struct telemetry_batch_struct *batch = &batches[current_batch];
+  int *values = &batch->port_values[batch->number_rows * header.number_ports + port_index];
+  values[0] = ships_in_port;
+  values[TELEMETRY_BATCH_ROWS * header.number_ports] = cargo_shipped;
+  values[2 * TELEMETRY_BATCH_ROWS * header.number_ports] = cargo_arrived;
+}
+
+// Completes the row for a timestep once each process has recorded its ports, along with the ships at sea held by this
+// process. Once a batch of rows is complete it is sent on its way to the file, every process must call this together
+void recordTelemetry(int ships_at_sea)
+{
+  struct telemetry_batch_struct *batch = &batches[current_batch];
+  batch->ships_at_sea[batch->number_rows] = ships_at_sea;
+  batch->number_rows++;
+  if (batch->number_rows == TELEMETRY_BATCH_ROWS)
+    flushBatch();
+}
+
+// Sends any rows that have not yet been written to the file and waits for all of the writes to reach it, so that the
+// file holds every row recorded so far (e.g. before a checkpoint). Every process must call this together
+void flushTelemetry()
+{
+  if (batches[current_batch].number_rows > 0)
+    flushBatch();
+  for (int i = 0; i < 2; i++)
+  {
+    if (batches[i].state == BATCH_REDUCING)
+    {
+      MPI_Waitall(2, batches[i].collective_requests, MPI_STATUSES_IGNORE);
+      startBatchWrites(&batches[i]);
+    }
+    waitForBatch(&batches[i]);
+  }
+  if (myrank == 0)
+    MPI_File_sync(telemetry_file);
+}
+
+// Writes out any rows that have not yet been written to the file, then closes the file. Every process must call this
+// together
+void finaliseTelemetry()
+{
+  flushTelemetry();
+  for (int i = 0; i < 2; i++)
+  {
+    free(batches[i].port_values);
+    free(batches[i].ships_at_sea);
+    free(batches[i].hours);
+    free(batches[i].reduced_port_values);
+    free(batches[i].gathered_ships_at_sea);
+    free(batches[i].ships_at_sea_rows);
+  }
+  if (myrank == 0)
+    MPI_File_close(&telemetry_file);
+}
+
+// Starts combining the current batch onto process 0 without waiting for this to complete, and switches to filling the
+// other batch. The other batch was sent one batch ago, so its reduction will normally have completed by now and its rows
+// can be written, whilst the writes of the current batch's buffers from two batches ago must finish before it is reused
+static void flushBatch()
+{
+  struct telemetry_batch_struct *batch = &batches[current_batch];
+  struct telemetry_batch_struct *other_batch = &batches[1 - current_batch];
+  waitForBatch(batch);
+  MPI_Ireduce(batch->port_values, batch->reduced_port_values, PORT_METRICS * TELEMETRY_BATCH_ROWS * header.number_ports, MPI_INT,
+              MPI_SUM, 0, MPI_COMM_WORLD, &batch->collective_requests[0]);
+  MPI_Igather(batch->ships_at_sea, TELEMETRY_BATCH_ROWS, MPI_INT, batch->gathered_ships_at_sea, TELEMETRY_BATCH_ROWS, MPI_INT, 0,
+              MPI_COMM_WORLD, &batch->collective_requests[1]);
+  batch->state = BATCH_REDUCING;
+
+  if (other_batch->state == BATCH_REDUCING)
+  {
+    MPI_Waitall(2, other_batch->collective_requests, MPI_STATUSES_IGNORE);
+    startBatchWrites(other_batch);
+  }
+  resetBatch(other_batch, batch->first_row + batch->number_rows);
+  current_batch = 1 - current_batch;
+}
+
+// Once a batch has been combined onto process 0 this starts writing each of its columns into the file there, each column
+// of the batch is a single contiguous write
+static void startBatchWrites(struct telemetry_batch_struct *batch)
+{
+  batch->state = BATCH_WRITING;
+  if (myrank != 0)
+    return;
+  struct telemetry_column_struct *columns = header.columns;
+  for (int row = 0; row < batch->number_rows; row++)
+  {
+    batch->hours[row] = (header.first_timestep + (batch->first_row + row) * header.every) * header.dt;
+    for (int process = 0; process < size; process++)
+      batch->ships_at_sea_rows[row * size + process] = batch->gathered_ships_at_sea[process * TELEMETRY_BATCH_ROWS + row];
+  }
+  MPI_File_iwrite_at(telemetry_file, columns[TELEMETRY_HOURS].offset + (MPI_Offset)batch->first_row * sizeof(int), batch->hours,
+                     batch->number_rows, MPI_INT, &batch->write_requests[TELEMETRY_HOURS]);
+  for (int metric = 0; metric < PORT_METRICS; metric++)
+  {
+    struct telemetry_column_struct *column = &columns[TELEMETRY_SHIPS_IN_PORT + metric];
+    MPI_File_iwrite_at(telemetry_file, column->offset + (MPI_Offset)batch->first_row * column->width * sizeof(int),
+                       &batch->reduced_port_values[metric * TELEMETRY_BATCH_ROWS * header.number_ports], batch->number_rows * column->width,
+                       MPI_INT, &batch->write_requests[TELEMETRY_SHIPS_IN_PORT + metric]);
+  }
+  MPI_File_iwrite_at(telemetry_file, columns[TELEMETRY_SHIPS_AT_SEA].offset + (MPI_Offset)batch->first_row * size * sizeof(int),
+                     batch->ships_at_sea_rows, batch->number_rows * size, MPI_INT, &batch->write_requests[TELEMETRY_SHIPS_AT_SEA]);
+}
+
+// Waits for the writes of a batch to complete, after which the buffers that process 0 combines it into can be reused
+static void waitForBatch(struct telemetry_batch_struct *batch)
+{
+  if (batch->state == BATCH_WRITING)
+    MPI_Waitall(TELEMETRY_COLUMNS, batch->write_requests, MPI_STATUSES_IGNORE);
+  batch->state = BATCH_IDLE;
+}
+
+// Empties a batch ready to be filled with rows from the first row provided, ports not owned by this process stay zero
+static void resetBatch(struct telemetry_batch_struct *batch, int first_row)
+{
+  batch->first_row = first_row;
+  batch->number_rows = 0;
+  memset(batch->port_values, 0, sizeof(int) * PORT_METRICS * TELEMETRY_BATCH_ROWS * header.number_ports);
+}
+
+// Describes a column of the file in the header, which starts at the offset provided. The offset is then moved on to the
+// end of the column
+static void setColumn(int column, char *name, int width, long long *offset)
+{
+  strncpy(header.columns[column].name, name, TELEMETRY_NAME_LENGTH - 1);
+  header.columns[column].width = width;
+  header.columns[column].offset = *offset;
+  *offset += (long long)header.number_rows * width * sizeof(int);
+}
@@ -0,0 +1,41 @@
+#ifndef TELEMETRY_INCLUDE
+#define TELEMETRY_INCLUDE
+
+#define TELEMETRY_MAGIC 0x4d4c4554
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_COLUMNS 5
+#define TELEMETRY_NAME_LENGTH 24
+
+// The columns of a telemetry file, each holds one integer per row for every entry across its width
+#define TELEMETRY_HOURS 0         // Hours into the simulation of each row, one wide
+#define TELEMETRY_SHIPS_IN_PORT 1 // Ships in each port, one entry per port
+#define TELEMETRY_CARGO_SHIPPED 2 // Cargo shipped by each port since the start of the run, one entry per port
+#define TELEMETRY_CARGO_ARRIVED 3 // Cargo arrived at each port since the start of the run, one entry per port
+#define TELEMETRY_SHIPS_AT_SEA 4  // Ships at sea held by each process, one entry per process
+
+// A column of a telemetry file, which holds number_rows by width integers (row after row) starting at offset bytes
+// into the file
+struct telemetry_column_struct
+{
+  char name[TELEMETRY_NAME_LENGTH];
+  int width;
+  long long offset;
+};
+
+// Start of a telemetry file, which is followed by the columns one after another. A run restarted from a checkpoint writes
+// a file of its own, with the rows from the timestep it restarted from (first_timestep) to the end of the run
+// number_rows = number of timesteps recorded, starting from first_timestep and then every timesteps
+struct telemetry_header_struct
+{
+  int magic, version;
+  int number_ports, number_processes, number_rows, first_timestep, every, dt;
+  struct telemetry_column_struct columns[TELEMETRY_COLUMNS];
+};
+
+void initialiseTelemetry(char *, int, int, int, int, int);
+void recordTelemetryPort(int, int, int, int);
+void recordTelemetry(int);
+void flushTelemetry();
+void finaliseTelemetry();
+
+#endif
@@ -0,0 +1,114 @@
+#!/bin/bash
+
+# Runs the simulation over a range of process counts and prints a CSV row per run, with the time of route planning and of
+# the simulation, the throughput in ship moves (summed over the processes) and timesteps per second, and the mean time
+# per process spent migrating ships, which compares the migration modes (MIGRATION_MODE) of two configurations
+#
+# Strong scaling runs one text configuration on each number of processes:
+#   tools/benchmark.sh strong config_2.txt 1 2 4 8 > strong.csv
+# Weak scaling generates a scenario for each number of processes, with the size in X and the number of ports given per
+# process, so that the work per process stays the same:
+#   tools/benchmark.sh weak 256 1024 4 0.01 10 1000 1 2 4 8 > weak.csv
+#
+# MPIRUN sets how the processes are launched (by default oversubscribing a single machine), OMP_NUM_THREADS the threads
+# per process (by default one) and REPEATS how many times each run is repeated (by default once)
+
+MPIRUN=${MPIRUN:-"mpirun --oversubscribe"}
+export OMP_NUM_THREADS=${OMP_NUM_THREADS:-1}
+REPEATS=${REPEATS:-1}
+SCENARIO_DIR=${SCENARIO_DIR:-/tmp}
+
+usage() {
+  echo "Usage: $0 strong CONFIG PROCESSES..." >&2
+  echo "       $0 weak SIZE_X SIZE_Y PORTS ISLAND_DENSITY INITIAL_SHIPS TIMESTEPS PROCESSES..." >&2
+  exit 1
+}
+
+# Prints the value of a setting in a text configuration
+setting() {
+  grep -E "^$2=" "$1" | head -n 1 | cut -d= -f2
+}
+
+# Stops unless a configuration is in the text format, as the settings of the report are read from the text. Binary
+# configurations start with the magic number 0x47464353, which is SCFG in the bytes of the file
+check_configuration() {
+  if [ ! -r "$1" ]; then
+    echo "Error, unable to read the configuration file '$1'" >&2
+    exit 1
+  fi
+  if [ "$(head -c 4 "$1")" == "SCFG" ]; then
+    echo "Error, '$1' is a binary configuration, benchmark the text configuration it was converted from instead" >&2
+    exit 1
+  fi
+  if [ -z "$(setting "$1" SIZE_X)" ] || [ -z "$(setting "$1" SIZE_Y)" ] || [ -z "$(setting "$1" NUM_TIMESTEPS)" ]; then
+    echo "Error, '$1' does not set SIZE_X, SIZE_Y and NUM_TIMESTEPS, which the report needs" >&2
+    exit 1
+  fi
+}
+
+# Runs a configuration on a number of processes and prints its row of the report
+run() {
+  local config=$1 processes=$2 repeat=$3
+  local output
+  echo "Running $config on $processes processes ($repeat of $REPEATS)" >&2
+  if ! output=$($MPIRUN -n "$processes" ./ships "$config" 2>&1); then
+    echo "Error, the run of $config on $processes processes failed:" >&2
+    echo "$output" >&2
+    exit 1
+  fi
+  echo "$output" | awk -v config="$config" -v processes="$processes" -v threads="$OMP_NUM_THREADS" -v repeat="$repeat" \
+    -v size_x="$(setting "$config" SIZE_X)" -v size_y="$(setting "$config" SIZE_Y)" \
+    -v ports="$(setting "$config" NUM_PORTS)" -v timesteps="$(setting "$config" NUM_TIMESTEPS)" '
+    /^The time of route planning is/ { planning = $NF }
+    /^The time of simulation is/ { simulation = $NF }
+    $1 == "ships_moved" { moves = $3 * processes }
+    $1 == "migration" { migration = $3 }
+    END {
+      moves_per_second = simulation > 0 ? moves / simulation : 0
+      timesteps_per_second = simulation > 0 ? timesteps / simulation : 0
+      printf "%s,%d,%d,%d,%d,%d,%d,%d,%.6f,%.6f,%.0f,%.1f,%.2f,%.6f\n", config, processes, threads, repeat, size_x, size_y, ports,
+             timesteps, planning, simulation, moves, moves_per_second, timesteps_per_second, migration
+    }'
+}
+
+[ $# -ge 1 ] || usage
+mode=$1
+shift
+if [ ! -x ./ships ]; then
+  echo "Error, build the simulation with make before benchmarking it" >&2
+  exit 1
+fi
+
+# The configuration of strong scaling is checked before anything is printed, so a bad one gives no partial CSV
+if [ "$mode" == "strong" ] && [ $# -ge 1 ]; then
+  check_configuration "$1"
+fi
+
+echo "config,processes,threads,repeat,size_x,size_y,ports,timesteps,route_planning_s,simulation_s,ship_moves,ship_moves_per_s,timesteps_per_s,migration_s"
+if [ "$mode" == "strong" ]; then
+  [ $# -ge 2 ] || usage
+  config=$1
+  shift
+  for processes in "$@"; do
+    for repeat in $(seq 1 "$REPEATS"); do
+      run "$config" "$processes" "$repeat"
+    done
+  done
+elif [ "$mode" == "weak" ]; then
+  [ $# -ge 7 ] || usage
+  size_x=$1 size_y=$2 ports=$3 density=$4 ships=$5 timesteps=$6
+  shift 6
+  if [ ! -x ./generate_scenario ]; then
+    echo "Error, build the scenario generator with make generate_scenario before benchmarking weak scaling" >&2
+    exit 1
+  fi
+  for processes in "$@"; do
+    config=$SCENARIO_DIR/scenario_weak_$processes.txt
+    ./generate_scenario "$config" $((size_x * processes)) "$size_y" $((ports * processes)) "$density" "$ships" "$timesteps" >&2 || exit 1
+    for repeat in $(seq 1 "$REPEATS"); do
+      run "$config" "$processes" "$repeat"
+    done
+  done
+else
+  usage
+fi
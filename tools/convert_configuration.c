@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include "../src/simulation_configuration.h"
+
+// Converts a configuration file from the text format into the binary format, which the simulation loads by memory mapping
+// it rather than parsing it. Usage: ./convert_configuration config.txt config.bin
+int main(int argc, char *argv[])
+{
+  struct simulation_configuration_struct simulation_configuration;
+  if (argc < 3)
+  {
+    fprintf(stderr, "You must provide the text configuration to read and the binary configuration to write\n");
+    return -1;
+  }
+  readConfiguration(argv[1], &simulation_configuration);
+  writeBinaryConfiguration(argv[2], &simulation_configuration);
+  printf("Converted %s to %s, with %d ports and %d islands on a %d by %d domain\n", argv[1], argv[2],
+         simulation_configuration.number_ports, simulation_configuration.number_islands, simulation_configuration.size_x,
+         simulation_configuration.size_y);
+  return 0;
+}
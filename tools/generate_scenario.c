@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../src/route_map.h"
+
+// Each attempt at placing the ports and islands that leaves a port cut off from the others is thrown away, up to this many
+#define MAX_ATTEMPTS 100
+#define MIN_CARGO 10
+#define MAX_CARGO 50
+
+static unsigned int random_state;
+
+static unsigned int getRandomNumber();
+static bool placeScenario(int, int, int, double, int *, unsigned char *);
+static bool arePortsRoutable(int, int, int, int *, unsigned char *);
+
+// Generates a synthetic configuration for benchmarking, with ports placed at random and each remaining cell an island with
+// the density given. Placements where some route between ports can not be planned, by the planner that the simulation
+// is built with (ROUTE_PLANNER_TO_USE, which must be given the same when building this), are thrown away and drawn
+// again. The same arguments always give the same configuration.
+// Usage: ./generate_scenario scenario.txt size_x size_y ports island_density initial_ships [timesteps] [seed]
+int main(int argc, char *argv[])
+{
+  if (argc < 7)
+  {
+    fprintf(stderr, "You must provide the configuration to write, the size in X and Y, the number of ports, the island density "
+                    "and the initial ships per port, and optionally the number of timesteps and seed\n");
+    return -1;
+  }
+  int size_x = atoi(argv[2]), size_y = atoi(argv[3]), number_ports = atoi(argv[4]), initial_ships = atoi(argv[6]);
+  double island_density = atof(argv[5]);
+  int number_timesteps = argc > 7 ? atoi(argv[7]) : 1000;
+  int seed = argc > 8 ? atoi(argv[8]) : 1;
+  if (size_x < 1 || size_y < 1 || number_ports < 2 || (long long)number_ports > (long long)size_x * size_y ||
+      island_density < 0.0 || island_density >= 1.0 || initial_ships < 0 || number_timesteps < 1 || seed < 0)
+  {
+    fprintf(stderr, "Error, the scenario needs at least two ports that fit in the domain and an island density below one\n");
+    return -1;
+  }
+
+  int *ports = (int *)malloc(sizeof(int) * number_ports * 2);
+  unsigned char *islands = (unsigned char *)malloc((size_t)size_x * size_y);
+  random_state = (unsigned int)seed * 0x9e3779b9U + 1;
+  int attempt = 0;
+  while (!placeScenario(size_x, size_y, number_ports, island_density, ports, islands))
+  {
+    if (++attempt == MAX_ATTEMPTS)
+    {
+      fprintf(stderr, "Error, unable to place %d ports with routes between them all at an island density of %g\n", number_ports,
+              island_density);
+      return -1;
+    }
+  }
+
+  FILE *f = fopen(argv[1], "w");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Error, unable to open the configuration file '%s'\n", argv[1]);
+    return -1;
+  }
+  long long number_islands = 0;
+  for (long long cell = 0; cell < (long long)size_x * size_y; cell++)
+    number_islands += islands[cell];
+  fprintf(f, "# Synthetic scenario: ./generate_scenario %s %d %d %d %g %d %d %d\n\n", argv[1], size_x, size_y, number_ports,
+          island_density, initial_ships, number_timesteps, seed);
+  fprintf(f, "SIZE_X=%d\nSIZE_Y=%d\nNUM_TIMESTEPS=%d\nDT=10\nINITIAL_SHIPS=%d\nREPORT_STATS_EVERY=%d\nSEED=%d\n\n", size_x, size_y,
+          number_timesteps, initial_ships, number_timesteps >= 10 ? number_timesteps / 10 : 1, seed);
+  fprintf(f, "NUM_PORTS=%d\n", number_ports);
+  for (int i = 0; i < number_ports; i++)
+    fprintf(f, "PORT_%d_X=%d\nPORT_%d_Y=%d\nPORT_%d_CARGO=%d\n", i, ports[i * 2], i, ports[i * 2 + 1], i,
+            MIN_CARGO + (int)(getRandomNumber() % (MAX_CARGO - MIN_CARGO + 1)));
+  fprintf(f, "\nNUM_ISLANDS=%lld\n", number_islands);
+  long long island = 0;
+  for (int x = 0; x < size_x; x++)
+  {
+    for (int y = 0; y < size_y; y++)
+    {
+      if (islands[(long long)x * size_y + y])
+      {
+        fprintf(f, "ISLAND_%lld_X=%d\nISLAND_%lld_Y=%d\n", island, x, island, y);
+        island++;
+      }
+    }
+  }
+  fclose(f);
+  printf("Generated %s, with %d ports and %lld islands on a %d by %d domain\n", argv[1], number_ports, number_islands, size_x, size_y);
+  free(ports);
+  free(islands);
+  return 0;
+}
+
+// Returns the next number of a xorshift generator, which is the same on every platform unlike rand
+static unsigned int getRandomNumber()
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Places the ports on distinct cells and then the islands on the remaining cells, each cell (indexed by x * size_y + y)
+// of islands being set if it is an island. Returns whether every route between the ports can be planned
+static bool placeScenario(int size_x, int size_y, int number_ports, double island_density, int *ports, unsigned char *islands)
+{
+  long long number_cells = (long long)size_x * size_y;
+  for (long long cell = 0; cell < number_cells; cell++)
+    islands[cell] = 0;
+  // Ports are marked in the island map whilst placing them, so that no two share a cell
+  for (int i = 0; i < number_ports; i++)
+  {
+    long long cell;
+    do
+    {
+      cell = (long long)((((unsigned long long)getRandomNumber() << 32) | getRandomNumber()) % (unsigned long long)number_cells);
+    } while (islands[cell]);
+    islands[cell] = 1;
+    ports[i * 2] = (int)(cell / size_y);
+    ports[i * 2 + 1] = (int)(cell % size_y);
+  }
+  unsigned int threshold = (unsigned int)(island_density * 4294967296.0);
+  for (long long cell = 0; cell < number_cells; cell++)
+    islands[cell] = islands[cell] ? 0 : getRandomNumber() < threshold;
+  for (int i = 0; i < number_ports; i++)
+    islands[(long long)ports[i * 2] * size_y + ports[i * 2 + 1]] = 0;
+  return arePortsRoutable(size_x, size_y, number_ports, ports, islands);
+}
+
+// Returns whether the route from every port to every other can be planned by the planner of the simulation. The greedy
+// planner never backtracks, so it can be stopped by clusters of islands that the shortest planner finds a way around
+static bool arePortsRoutable(int size_x, int size_y, int number_ports, int *ports, unsigned char *islands)
+{
+  struct simulation_configuration_struct configuration = {0};
+  configuration.size_x = size_x;
+  configuration.size_y = size_y;
+  configuration.number_ports = number_ports;
+  configuration.ports = (struct port_configuration_struct *)calloc(number_ports, sizeof(struct port_configuration_struct));
+  for (int i = 0; i < number_ports; i++)
+  {
+    configuration.ports[i].x = ports[i * 2];
+    configuration.ports[i].y = ports[i * 2 + 1];
+  }
+  long long number_cells = (long long)size_x * size_y;
+  for (long long cell = 0; cell < number_cells; cell++)
+    configuration.number_islands += islands[cell];
+  configuration.islands = (struct island_configuration_struct *)malloc(sizeof(struct island_configuration_struct) *
+                                                                       (configuration.number_islands > 0 ? configuration.number_islands : 1));
+  for (long long cell = 0, island = 0; cell < number_cells; cell++)
+  {
+    if (islands[cell])
+    {
+      configuration.islands[island].x = (int)(cell / size_y);
+      configuration.islands[island].y = (int)(cell % size_y);
+      island++;
+    }
+  }
+  initialiseCellLookups(&configuration);
+
+#if ROUTE_PLANNER_TO_USE == 0
+  bool routable = can_plan_all_routes(&configuration, generate_route);
+#elif ROUTE_PLANNER_TO_USE == 1
+  bool routable = can_plan_all_routes(&configuration, generate_shortest_route);
+#endif
+
+  free(configuration.ports);
+  free(configuration.islands);
+  free(configuration.island_bitmap);
+  free(configuration.port_hash_cells);
+  free(configuration.port_hash_indexes);
+  return routable;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/telemetry.h"
+
+// A telemetry file of one segment of a run, the whole run when it was never restarted, otherwise the first segment
+// (ships.tel) followed by one for each restart from a checkpoint. number_rows is how many of its rows are used, which
+// stops short of the rows that a later segment recorded again after restarting
+struct segment_struct
+{
+  char *filename;
+  FILE *f;
+  struct telemetry_header_struct header;
+  int number_rows;
+};
+
+static void openSegment(char *, struct segment_struct *);
+static int compareSegments(const void *, const void *);
+static int *readColumn(struct segment_struct *, int);
+
+// Reads the telemetry written by the simulation. Given just the files this describes the columns that they hold, and
+// given the name of a column as well this prints that column as CSV, with a row per recorded timestep that starts with
+// the hours into the simulation. A run restarted from a checkpoint writes a file for each segment of the run, which are
+// joined back together in order of timestep when given together (the processes of a segment that ran on fewer than the
+// others are left empty in the ships_at_sea column)
+// Usage: ./read_telemetry ships.tel [ships_1000.tel ...] [column]
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "You must provide the telemetry files to read, and optionally the name of a column to print\n");
+    return -1;
+  }
+  // The last argument is a column rather than a file if there is no file of that name
+  char *column_name = NULL;
+  int number_segments = argc - 1;
+  FILE *last = fopen(argv[argc - 1], "rb");
+  if (last == NULL && argc > 2)
+  {
+    column_name = argv[argc - 1];
+    number_segments--;
+  }
+  if (last != NULL)
+    fclose(last);
+
+  struct segment_struct *segments = (struct segment_struct *)malloc(sizeof(struct segment_struct) * number_segments);
+  for (int i = 0; i < number_segments; i++)
+    openSegment(argv[i + 1], &segments[i]);
+  qsort(segments, number_segments, sizeof(struct segment_struct), compareSegments);
+
+  // Every segment must be of the same run, which ends at the same timestep, with each taking over from the one before
+  struct telemetry_header_struct *first = &segments[0].header;
+  int last_timestep = first->first_timestep + first->number_rows * first->every;
+  int number_rows = 0;
+  for (int i = 0; i < number_segments; i++)
+  {
+    struct telemetry_header_struct *header = &segments[i].header;
+    if (header->number_ports != first->number_ports || header->every != first->every || header->dt != first->dt ||
+        header->first_timestep + header->number_rows * header->every != last_timestep ||
+        (i > 0 && header->first_timestep == segments[i - 1].header.first_timestep))
+    {
+      fprintf(stderr, "Error, '%s' and '%s' are not segments of the same run\n", segments[0].filename, segments[i].filename);
+      return -1;
+    }
+    if (i + 1 < number_segments)
+      segments[i].number_rows = (segments[i + 1].header.first_timestep - header->first_timestep) / header->every;
+    number_rows += segments[i].number_rows;
+  }
+
+  if (column_name == NULL)
+  {
+    int max_processes = 0;
+    for (int i = 0; i < number_segments; i++)
+    {
+      if (segments[i].header.number_processes > max_processes)
+        max_processes = segments[i].header.number_processes;
+    }
+    printf("%d rows, every %d timesteps of %d hours from timestep %d, for %d ports over up to %d processes\n", number_rows,
+           first->every, first->dt, first->first_timestep, first->number_ports, max_processes);
+    for (int i = 0; i < TELEMETRY_COLUMNS; i++)
+      printf("%s: %d by %d\n", first->columns[i].name, number_rows, i == TELEMETRY_SHIPS_AT_SEA ? max_processes : first->columns[i].width);
+    if (number_segments > 1)
+    {
+      for (int i = 0; i < number_segments; i++)
+        printf("%s: %d rows from timestep %d over %d processes\n", segments[i].filename, segments[i].number_rows,
+               segments[i].header.first_timestep, segments[i].header.number_processes);
+    }
+    return 0;
+  }
+
+  int column = -1;
+  for (int i = 0; i < TELEMETRY_COLUMNS; i++)
+  {
+    if (strcmp(column_name, first->columns[i].name) == 0)
+      column = i;
+  }
+  if (column == -1)
+  {
+    fprintf(stderr, "Error, there is no column '%s' in the telemetry file\n", column_name);
+    return -1;
+  }
+
+  int width = 0;
+  for (int i = 0; i < number_segments; i++)
+  {
+    if (segments[i].header.columns[column].width > width)
+      width = segments[i].header.columns[column].width;
+  }
+  printf("hours");
+  for (int j = 0; j < width; j++)
+    printf(",%d", j);
+  printf("\n");
+  for (int i = 0; i < number_segments; i++)
+  {
+    int *hours = readColumn(&segments[i], TELEMETRY_HOURS);
+    int *values = readColumn(&segments[i], column);
+    int segment_width = segments[i].header.columns[column].width;
+    for (int row = 0; row < segments[i].number_rows; row++)
+    {
+      printf("%d", hours[row]);
+      for (int j = 0; j < width; j++)
+      {
+        if (j < segment_width)
+          printf(",%d", values[(long long)row * segment_width + j]);
+        else
+          printf(",");
+      }
+      printf("\n");
+    }
+    free(hours);
+    free(values);
+    fclose(segments[i].f);
+  }
+  free(segments);
+  return 0;
+}
+
+// Opens a telemetry file and reads its header, all of its rows are used unless a later segment takes over from it
+static void openSegment(char *filename, struct segment_struct *segment)
+{
+  segment->filename = filename;
+  segment->f = fopen(filename, "rb");
+  if (segment->f == NULL || fread(&segment->header, sizeof(struct telemetry_header_struct), 1, segment->f) != 1 ||
+      segment->header.magic != TELEMETRY_MAGIC || segment->header.version != TELEMETRY_VERSION)
+  {
+    fprintf(stderr, "Error, '%s' is not a telemetry file written by this version of the simulation\n", filename);
+    exit(-1);
+  }
+  segment->number_rows = segment->header.number_rows;
+}
+
+// Orders segments by the timestep that they start from
+static int compareSegments(const void *a, const void *b)
+{
+  return ((struct segment_struct *)a)->header.first_timestep - ((struct segment_struct *)b)->header.first_timestep;
+}
+
+// Reads the rows of a column of a segment that are used, which the caller must free
+static int *readColumn(struct segment_struct *segment, int column)
+{
+  struct telemetry_column_struct *telemetry_column = &segment->header.columns[column];
+  long long number_values = (long long)segment->number_rows * telemetry_column->width;
+  int *values = (int *)malloc(sizeof(int) * (number_values + 1));
+  if (fseek(segment->f, telemetry_column->offset, SEEK_SET) != 0 ||
+      (long long)fread(values, sizeof(int), number_values, segment->f) != number_values)
+  {
+    fprintf(stderr, "Error, the telemetry file '%s' ends part way through the %s column\n", segment->filename, telemetry_column->name);
+    exit(-1);
+  }
+  return values;
+}